@@ -85,6 +85,8 @@ if(OpenMP_FOUND OR OpenMP_CXX_FOUND)
 
     # OpenMP has been tested successfully, enable it
     if(OpenMP OR OpenMP_with_libatomic)
+        set(HAVE_OPENMP TRUE)
+
         if(TARGET OpenMP::OpenMP_CXX)
             set(LIB_OPENMP "OpenMP::OpenMP_CXX")
         else()
@@ -98,13 +100,13 @@ if(OpenMP_FOUND OR OpenMP_CXX_FOUND)
     endif()
 endif()
 
-# OpenMP test has failed, print warning message
-if(NOT OpenMP AND NOT OpenMP_with_libatomic)
+# OpenMP test has failed, primecount will use std::thread
+if(NOT HAVE_OPENMP)
     if (CMAKE_CXX_COMPILER_ID MATCHES "Clang|LLVM")
-        message(WARNING "Install the OpenMP library (libomp) to enable multithreading in primecount!")
+        message(STATUS "libomp not found, using std::thread multi-threading")
     elseif (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
-        message(WARNING "Install the OpenMP library (libgomp) to enable multithreading in primecount!")
+        message(STATUS "libgomp not found, using std::thread multi-threading")
     else()
-        message(WARNING "Install the OpenMP library to enable multithreading in primecount!")
+        message(STATUS "OpenMP not found, using std::thread multi-threading")
     endif()
 endif()
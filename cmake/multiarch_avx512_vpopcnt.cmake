@@ -0,0 +1,54 @@
+# Check if the compiler supports the AVX512 VPOPCNTDQ instruction
+# set using the target attribute and if it supports runtime CPU
+# feature detection using __builtin_cpu_supports(). If so the
+# PiTable batch lookup is compiled with an AVX512 code path that
+# is only used if the CPU supports it. This way the primecount
+# binary remains portable.
+
+include(CheckCXXSourceCompiles)
+include(CMakePushCheckState)
+
+cmake_push_check_state()
+set(CMAKE_REQUIRED_INCLUDES "${PROJECT_SOURCE_DIR}/include")
+
+check_cxx_source_compiles("
+    #include <immintrin.h>
+    #include <stdint.h>
+
+    __attribute__ ((target (\"avx512f,avx512dq,avx512vpopcntdq\")))
+    void popcnt_avx512(const uint64_t* x, uint64_t* out)
+    {
+        __m512i v = _mm512_loadu_si512(x);
+        __m512d d = _mm512_cvtepu64_pd(v);
+        v = _mm512_cvttpd_epu64(d);
+        v = _mm512_popcnt_epi64(v);
+        v = _mm512_mask_i64gather_epi64(v, 0xff, v, (const long long*) x, 8);
+        _mm512_storeu_si512(out, v);
+    }
+
+    void popcnt_default(const uint64_t* x, uint64_t* out)
+    {
+        for (int i = 0; i < 8; i++)
+            out[i] = x[i];
+    }
+
+    int main()
+    {
+        uint64_t x[8] = { 0 };
+        uint64_t out[8];
+
+        if (__builtin_cpu_supports(\"avx512f\") &&
+            __builtin_cpu_supports(\"avx512dq\") &&
+            __builtin_cpu_supports(\"avx512vpopcntdq\"))
+            popcnt_avx512(x, out);
+        else
+            popcnt_default(x, out);
+
+        return (int) out[0];
+    }" multiarch_avx512_vpopcnt)
+
+if(multiarch_avx512_vpopcnt)
+    set(ENABLE_MULTIARCH_AVX512_VPOPCNT "ENABLE_MULTIARCH_AVX512_VPOPCNT")
+endif()
+
+cmake_pop_check_state()
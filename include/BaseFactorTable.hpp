@@ -4,7 +4,7 @@
 ///        FactorTable and FactorTableD classes.
 ///        See FactorTable.hpp for more information.
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -13,11 +13,15 @@
 #ifndef BASEFACTORTABLE_HPP
 #define BASEFACTORTABLE_HPP
 
+#include <generate.hpp>
 #include <imath.hpp>
 #include <macros.hpp>
+#include <parallel.hpp>
+#include <SegmentedPrimes.hpp>
 #include <Vector.hpp>
 
 #include <algorithm>
+#include <limits>
 #include <stdint.h>
 
 namespace primecount {
@@ -72,8 +76,184 @@ protected:
     return multiple;
   }
 
+  /// Initialize the factor table i.e. compute the least prime
+  /// factor and the Möbius function of the numbers <= max.
+  /// Numbers that have a prime factor > max_prime are set to 0,
+  /// this is used by FactorTableD to remove the primes > y and
+  /// the numbers with a prime factor > y.
+  ///
+  /// The sieving primes <= max / 13 are generated only once and
+  /// shared by all threads. The factor table is initialized in
+  /// small cache sized blocks which are distributed dynamically
+  /// to the threads, hence all threads finish at about the same
+  /// time. For each block, the multiples of the sieving primes
+  /// <= sqrt(max) are crossed off one prime at a time, whereas
+  /// the larger sieving primes (which have few multiples per
+  /// block) are found by iterating over the cofactors m of the
+  /// block's numbers n = prime * m and searching the primes
+  /// inside [low / m, high / m].
+  ///
+  template <typename T>
+  static void init_factor(Vector<T>& factor,
+                          int64_t max,
+                          int64_t max_prime,
+                          int threads)
+  {
+    int64_t max_sieving_prime = max / first_coprime();
+
+    if (max_sieving_prime <= std::numeric_limits<uint32_t>::max())
+    {
+      auto primes = generate_primes<uint32_t>(max_sieving_prime, threads);
+      init_factor(factor, primes, max, max_prime, threads);
+    }
+    else
+    {
+      SegmentedPrimes<uint64_t> primes(max_sieving_prime, threads);
+      init_factor(factor, primes, max, max_prime, threads);
+    }
+  }
+
   static const Array<uint16_t, 480> coprime_;
   static const Array<int16_t, 2310> coprime_indexes_;
+
+private:
+  template <typename T, typename Primes>
+  static void init_factor(Vector<T>& factor,
+                          const Primes& primes,
+                          int64_t max,
+                          int64_t max_prime,
+                          int threads)
+  {
+    // Each block uses about 512 KiB of the factor
+    // table, a multiple of 2310 numbers.
+    int64_t block_size = (1 << 19) / (480 * sizeof(T)) * 2310;
+    int64_t blocks = ceil_div(max, block_size);
+    int64_t sqrt_max = isqrt(max);
+    int64_t thread_threshold = (int64_t) 1e7;
+    threads = ideal_num_threads(max, threads, thread_threshold);
+
+    // The sieving primes <= sqrt(max) are crossed off
+    // one prime at a time, the larger sieving primes
+    // are found by iterating over the cofactors m.
+    int64_t size = (int64_t) primes.size();
+    int64_t pi_13 = std::min(size, (int64_t) 6);
+    int64_t pi_sqrt = pi_13;
+    while (pi_sqrt < size && (int64_t) primes[pi_sqrt] <= sqrt_max)
+      pi_sqrt++;
+
+    parallel_for(threads, 0, blocks, 1, [&](int64_t b)
+    {
+      // Process the numbers inside [low, high]
+      int64_t low = block_size * b;
+      int64_t high = std::min(low + block_size, max);
+      low = std::max(first_coprime(), low + 1);
+
+      if (low > high)
+        return;
+
+      // Default initialize memory to all bits set
+      T T_MAX = std::numeric_limits<T>::max();
+      int64_t low_idx = to_index(low);
+      int64_t high_idx = to_index(high);
+      std::fill_n(&factor[low_idx], (high_idx + 1) - low_idx, T_MAX);
+
+      for (int64_t i = pi_13; i < pi_sqrt; i++)
+      {
+        int64_t prime = primes[i];
+        if (prime * first_coprime() > high)
+          break;
+
+        // Find multiples > prime
+        int64_t j = 1;
+        int64_t multiple = next_multiple(prime, low, &j);
+
+        if (prime > max_prime)
+        {
+          for (; multiple <= high; multiple = prime * to_number(j++))
+            factor[to_index(multiple)] = 0;
+          continue;
+        }
+
+        for (; multiple <= high; multiple = prime * to_number(j++))
+        {
+          int64_t mi = to_index(multiple);
+          // prime is the smallest factor of multiple
+          if (factor[mi] == T_MAX)
+            factor[mi] = (T) prime;
+          // the least significant bit indicates
+          // whether multiple has an even (0) or odd (1)
+          // number of prime factors
+          else if (factor[mi] != 0)
+            factor[mi] ^= 1;
+        }
+
+        j = 0;
+        int64_t square = prime * prime;
+        multiple = next_multiple(square, low, &j);
+
+        // Sieve out numbers that are not square free
+        // i.e. numbers for which moebius(n) = 0.
+        for (; multiple <= high; multiple = square * to_number(j++))
+          factor[to_index(multiple)] = 0;
+      }
+
+      // Large sieving primes > sqrt(max): n = prime * m with
+      // m < prime. The primes of a number n are not visited
+      // in ascending order, hence we keep the minimum prime.
+      int64_t max_i = size;
+
+      for (int64_t j = 1; true; j++)
+      {
+        int64_t m = to_number(j);
+        if (m * (sqrt_max + 1) > high)
+          break;
+
+        // Binary search the 1st prime >= min_prime
+        int64_t min_prime = std::max(sqrt_max + 1, ceil_div(low, m));
+        int64_t max_p = high / m;
+        int64_t i = pi_sqrt;
+        int64_t k = max_i;
+
+        while (i < k)
+        {
+          int64_t mid = i + (k - i) / 2;
+          if ((int64_t) primes[mid] < min_prime)
+            i = mid + 1;
+          else
+            k = mid;
+        }
+
+        max_i = i;
+
+        for (; i < size && (int64_t) primes[i] <= max_p; i++)
+        {
+          int64_t prime = primes[i];
+          int64_t mi = to_index(prime * m);
+
+          if (prime > max_prime)
+            factor[mi] = 0;
+          else if (factor[mi] == T_MAX)
+            factor[mi] = (T) prime;
+          else if (factor[mi] != 0)
+          {
+            int64_t lpf = std::min((int64_t) (factor[mi] | 1), prime);
+            factor[mi] = (T) (lpf ^ (factor[mi] & 1));
+          }
+        }
+      }
+
+      // Sieve out the primes > max_prime
+      if (max_prime < high)
+      {
+        int64_t i = to_index(std::max(low, max_prime + 1));
+        for (; to_number(i) <= max_prime; i++);
+
+        for (; i <= high_idx; i++)
+          if (factor[i] == T_MAX)
+            factor[i] = 0;
+      }
+    });
+  }
 };
 
 } // namespace 
@@ -8,7 +8,7 @@
 ///        uses the uint64_t data type, one sieve array element
 ///        (8 bytes) corresponds to an interval of size 30 * 8 = 240.
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -18,13 +18,37 @@
 #define BITSIEVE240_HPP
 
 #include <Vector.hpp>
+
 #include <stdint.h>
+#include <cstddef>
 
 namespace primecount {
 
 class BitSieve240
 {
 protected:
+  /// Element of the PiTable and SegmentedPiTable lookup tables,
+  /// count = number of primes < low of the 240 numbers interval.
+  struct pi_t
+  {
+    uint64_t count;
+    uint64_t bits;
+  };
+
+  /// Get the number of primes <= xs[i] for i < n.
+  /// Uses AVX512 gather and VPOPCNTDQ instructions if the
+  /// CPU supports them (runtime dispatch).
+  /// @pi:   PiTable or SegmentedPiTable lookup table.
+  /// @low:  Start of the lookup table, low % 240 == 0.
+  /// @size: Number of integers in the lookup table.
+  ///
+  static void pi_lookup(const pi_t* pi,
+                        uint64_t low,
+                        uint64_t size,
+                        const uint64_t* xs,
+                        std::size_t n,
+                        int64_t* out);
+
   static const Array<uint64_t, 6> pi_tiny_;
   static const Array<uint64_t, 240> set_bit_;
   static const Array<uint64_t, 240> unset_bit_;
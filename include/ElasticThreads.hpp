@@ -0,0 +1,65 @@
+///
+/// @file  ElasticThreads.hpp
+/// @brief Change the number of threads that work on a running
+///        computation. The load balancers (LoadBalancerS2,
+///        LoadBalancerAC and LoadBalancerP2) hand out work units
+///        dynamically, before handing out the next work unit
+///        ElasticThreads::wait() parks the calling thread if
+///        more threads are working than the current limit. Parked
+///        threads resume once the limit is increased or once all
+///        work units have been handed out. The limit is set using
+///        set_active_threads() or it is read from a control file
+///        (see set_threads_file()).
+///
+///        Since the threads of a parallel region are created when
+///        the computation starts, a running computation can use at
+///        most the number of threads it was started with.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef ELASTICTHREADS_HPP
+#define ELASTICTHREADS_HPP
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+namespace primecount {
+
+class ElasticThreads
+{
+public:
+  ElasticThreads();
+  /// Must be called at the start of get_work(),
+  /// before acquiring the load balancer's lock.
+  void wait();
+  /// Must be called when get_work()
+  /// returns false (no more work).
+  void finish();
+
+private:
+  uint64_t id_ = 0;
+  // Number of threads that process a work unit
+  std::atomic<int> running_{0};
+  std::atomic<bool> is_finished_{false};
+};
+
+/// Read the number of active threads from filename
+/// (at most once per second) while computing.
+///
+void set_threads_file(const std::string& filename);
+
+/// Number of threads that currently process a work unit
+/// respectively that are currently parked. A thread that
+/// runs a nested load balancer is only counted once.
+///
+int get_running_threads();
+int get_parked_threads();
+
+} // namespace
+
+#endif
@@ -51,6 +51,7 @@
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <macros.hpp>
+#include <parallel.hpp>
 #include <Vector.hpp>
 
 #include <algorithm>
@@ -82,70 +83,7 @@ public:
     // has an even or odd number of prime factors.
     factor_[0] = T_MAX ^ 1;
 
-    int64_t sqrty = isqrt(y);
-    int64_t thread_threshold = (int64_t) 1e7;
-    threads = ideal_num_threads(y, threads, thread_threshold);
-    int64_t thread_distance = ceil_div(y, threads);
-    thread_distance += coprime_indexes_.size() - thread_distance % coprime_indexes_.size();
-
-    #pragma omp parallel for num_threads(threads)
-    for (int t = 0; t < threads; t++)
-    {
-      // Thread processes interval [low, high]
-      int64_t low = thread_distance * t;
-      int64_t high = low + thread_distance;
-      int64_t min_m = first_coprime() * first_coprime();
-      low = std::max(first_coprime(), low + 1);
-      high = std::min(high, y);
-
-      if (low <= high &&
-          min_m <= high)
-      {
-        // Default initialize memory to all bits set
-        int64_t low_idx = to_index(low);
-        int64_t size = (to_index(high) + 1) - low_idx;
-        std::fill_n(&factor_[low_idx], size, T_MAX);
-
-        int64_t start = first_coprime();
-        int64_t stop = high / first_coprime();
-        primesieve::iterator it(start, stop);
-
-        while (true)
-        {
-          int64_t i = 1;
-          int64_t prime = it.next_prime();
-          int64_t multiple = next_multiple(prime, low, &i);
-          min_m = prime * first_coprime();
-
-          if (min_m > high)
-            break;
-
-          for (; multiple <= high; multiple = prime * to_number(i++))
-          {
-            int64_t mi = to_index(multiple);
-            // prime is smallest factor of multiple
-            if (factor_[mi] == T_MAX)
-              factor_[mi] = (T) prime;
-            // the least significant bit indicates
-            // whether multiple has an even (0) or odd (1)
-            // number of prime factors
-            else if (factor_[mi] != 0)
-              factor_[mi] ^= 1;
-          }
-
-          if (prime <= sqrty)
-          {
-            int64_t j = 0;
-            int64_t square = prime * prime;
-            multiple = next_multiple(square, low, &j);
-
-            // moebius(n) = 0
-            for (; multiple <= high; multiple = square * to_number(j++))
-              factor_[to_index(multiple)] = 0;
-          }
-        }
-      }
-    }
+    init_factor(factor_, y, y, threads);
   }
 
   /// mu_lpf(n) is a combination of the mu(n) (Möbius function)
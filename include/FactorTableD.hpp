@@ -86,98 +86,8 @@ public:
     // has an even or odd number of prime factors.
     factor_[0] = T_MAX ^ 1;
 
-    int64_t sqrtz = isqrt(z);
-    int64_t thread_threshold = (int64_t) 1e7;
-    threads = ideal_num_threads(z, threads, thread_threshold);
-    int64_t thread_distance = ceil_div(z, threads);
-    thread_distance += coprime_indexes_.size() - thread_distance % coprime_indexes_.size();
-
-    #pragma omp parallel for num_threads(threads)
-    for (int t = 0; t < threads; t++)
-    {
-      // Thread processes interval [low, high]
-      int64_t low = thread_distance * t;
-      int64_t high = low + thread_distance;
-      low = std::max(first_coprime(), low + 1);
-      high = std::min(high, z);
-
-      if (low <= high)
-      {
-        // Default initialize memory to all bits set
-        int64_t low_idx = to_index(low);
-        int64_t size = (to_index(high) + 1) - low_idx;
-        std::fill_n(&factor_[low_idx], size, T_MAX);
-
-        int64_t start = first_coprime();
-        int64_t stop = high / first_coprime();
-        int64_t min_m = first_coprime() * first_coprime();
-        primesieve::iterator it(start, stop);
-
-        if (min_m <= high)
-        {
-          while (true)
-          {
-            // Find multiples > prime
-            int64_t i = 1;
-            int64_t prime = it.next_prime();
-            int64_t multiple = next_multiple(prime, low, &i);
-            min_m = prime * first_coprime();
-
-            if (min_m > high)
-              break;
-
-            for (; multiple <= high; multiple = prime * to_number(i++))
-            {
-              int64_t mi = to_index(multiple);
-              // prime is the smallest factor of multiple
-              if (factor_[mi] == T_MAX)
-                factor_[mi] = (T) prime;
-              // the least significant bit indicates
-              // whether multiple has an even (0) or odd (1)
-              // number of prime factors
-              else if (factor_[mi] != 0)
-                factor_[mi] ^= 1;
-            }
-
-            if (prime <= sqrtz)
-            {
-              int64_t j = 0;
-              int64_t square = prime * prime;
-              multiple = next_multiple(square, low, &j);
-
-              // Sieve out numbers that are not square free
-              // i.e. numbers for which moebius(n) = 0.
-              for (; multiple <= high; multiple = square * to_number(j++))
-                factor_[to_index(multiple)] = 0;
-            }
-          }
-        }
-
-        // Iterate over primes from [y+1, high]
-        start = std::max(start, y + 1);
-
-        if (start <= high)
-        {
-          it.jump_to(start, high);
-
-          // y < prime <= z
-          while (true)
-          {
-            int64_t i = 0;
-            int64_t prime = it.next_prime();
-            int64_t next = next_multiple(prime, low, &i);
-
-            if (prime > high)
-              break;
-
-            // Sieve out primes > y &&
-            // Sieve out numbers with prime factors > y
-            for (; next <= high; next = prime * to_number(i++))
-              factor_[to_index(next)] = 0;
-          }
-        }
-      }
-    }
+    // Numbers with a prime factor > y are set to 0
+    init_factor(factor_, z, y, threads);
   }
 
   /// Returns true if n (with n = to_number(index)) is a
@@ -0,0 +1,115 @@
+///
+/// @file  LeafStats.hpp
+/// @brief Optional special leaf statistics used for tuning the
+///        alpha factors and the load balancing. When primecount is
+///        built with -DWITH_LEAF_STATS=ON (which defines
+///        ENABLE_LEAF_STATS) the A, C, D, S2_easy and S2_hard
+///        formulas record the number of special leaves per b bucket
+///        and per low bucket, the number of Sieve::count() calls
+///        and the number of sieve words scanned and the number of
+///        clustered and sparse easy leaves.
+///
+///        The counters are thread-local (no synchronization in the
+///        hot loops), get_leaf_stats() merges the counters of all
+///        threads. When ENABLE_LEAF_STATS is not defined the
+///        LEAF_STATS(...) statements are removed by the
+///        preprocessor and hence have no runtime cost.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef LEAFSTATS_HPP
+#define LEAFSTATS_HPP
+
+#include <imath.hpp>
+
+#include <stdint.h>
+#include <string>
+
+#if defined(ENABLE_LEAF_STATS)
+  #define LEAF_STATS(statement) statement
+#else
+  #define LEAF_STATS(statement) do { } while (0)
+#endif
+
+namespace primecount {
+
+enum LeafFormula
+{
+  LEAF_A,
+  LEAF_C,
+  LEAF_D,
+  LEAF_S2_EASY,
+  LEAF_S2_HARD,
+  LEAF_FORMULAS
+};
+
+struct LeafStats
+{
+  /// Bucket i contains the leaves with b or low
+  /// inside [2^i, 2^(i+1)[, bucket 0 also contains 0.
+  enum { BUCKETS = 64 };
+
+  uint64_t b_leaves[LEAF_FORMULAS][BUCKETS];
+  uint64_t low_leaves[LEAF_FORMULAS][BUCKETS];
+  uint64_t clustered_leaves[LEAF_FORMULAS];
+  uint64_t sparse_leaves[LEAF_FORMULAS];
+  uint64_t sieve_count_calls;
+  uint64_t sieve_count_words;
+
+  /// Start of the thread's current segment,
+  /// 0 if the formula is not segmented.
+  uint64_t low;
+
+  LeafStats();
+  LeafStats& operator+=(const LeafStats& other);
+
+  void add_leaves(LeafFormula formula,
+                  uint64_t b,
+                  uint64_t leaves)
+  {
+    b_leaves[formula][ilog2(b)] += leaves;
+    low_leaves[formula][ilog2(low)] += leaves;
+  }
+
+  void add_clustered_leaves(LeafFormula formula,
+                            uint64_t b,
+                            uint64_t leaves)
+  {
+    clustered_leaves[formula] += leaves;
+    add_leaves(formula, b, leaves);
+  }
+
+  void add_sparse_leaves(LeafFormula formula,
+                         uint64_t b,
+                         uint64_t leaves)
+  {
+    sparse_leaves[formula] += leaves;
+    add_leaves(formula, b, leaves);
+  }
+
+  void add_sieve_count(uint64_t words)
+  {
+    sieve_count_calls += 1;
+    sieve_count_words += words;
+  }
+};
+
+/// Returns the calling thread's counters
+LeafStats& thread_leaf_stats();
+
+/// Merge the counters of all threads
+LeafStats get_leaf_stats();
+void reset_leaf_stats();
+
+/// Write the merged counters to a file using CSV
+/// format, or JSON format if filename ends with .json
+///
+void write_leaf_stats(const std::string& filename);
+
+} // namespace
+
+#endif
@@ -7,7 +7,7 @@
 ///        Load balancing is described in more detail at:
 ///        https://github.com/kimwalisch/primecount/blob/master/doc/Easy-Special-Leaves.md
 ///
-/// Copyright (C) 2021 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -16,8 +16,15 @@
 #ifndef LOADBALANCERAC_HPP
 #define LOADBALANCERAC_HPP
 
+#include <ElasticThreads.hpp>
 #include <OmpLock.hpp>
+#include <StatusThread.hpp>
+#include <ThreadGroups.hpp>
+#include <WorkLog.hpp>
+
 #include <stdint.h>
+#include <atomic>
+#include <memory>
 
 namespace primecount {
 
@@ -28,8 +35,10 @@ public:
   bool get_work(int64_t& low, int64_t& high);
 
 private:
+  bool get_chunk(int group);
   void validate_segment_sizes();
   void compute_total_segments();
+  void publish_status();
   void print_status();
 
   int64_t low_ = 0;
@@ -40,10 +49,18 @@ private:
   int64_t large_segment_size_ = 0;
   int64_t segment_nr_ = 0;
   int64_t total_segments_ = 0;
-  double time_ = 0;
   int threads_ = 0;
   bool is_print_ = false;
+  WorkLog log_;
+  ThreadGroups thread_groups_;
+  std::unique_ptr<ThreadGroup[]> groups_;
+  ElasticThreads elastic_;
   OmpLock lock_;
+  // Written by the worker threads,
+  // read by the status thread.
+  std::atomic<int64_t> status_segment_nr_{0};
+  // Must be destroyed first
+  StatusThread status_thread_;
 };
 
 } // namespace
@@ -4,7 +4,7 @@
 ///        computation of the 2nd partial sieve function.
 ///        It is used by the P2(x, a) and B(x, y) functions.
 ///
-/// Copyright (C) 2021 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -13,10 +13,15 @@
 #ifndef LOADBALANCERP2_HPP
 #define LOADBALANCERP2_HPP
 
+#include <ElasticThreads.hpp>
 #include <int128_t.hpp>
 #include <OmpLock.hpp>
+#include <StatusThread.hpp>
+#include <ThreadGroups.hpp>
 
 #include <stdint.h>
+#include <atomic>
+#include <memory>
 
 namespace primecount {
 
@@ -28,17 +33,26 @@ public:
   int get_threads() const;
 
 private:
+  bool get_chunk(int group);
+  void publish_status();
   void print_status();
 
   int64_t low_ = 0;
   int64_t sieve_limit_ = 0;
   int64_t min_thread_dist_ = 0;
   int64_t thread_dist_ = 0;
-  double time_ = 0;
   int threads_ = 0;
   int precision_ = 0;
   bool is_print_ = false;
+  ThreadGroups thread_groups_;
+  std::unique_ptr<ThreadGroup[]> groups_;
+  ElasticThreads elastic_;
   OmpLock lock_;
+  // Written by the worker threads,
+  // read by the status thread.
+  std::atomic<int64_t> status_low_{0};
+  // Must be destroyed first
+  StatusThread status_thread_;
 };
 
 } // namespace
@@ -1,7 +1,7 @@
 ///
 /// @file  LoadBalancerS2.hpp
 ///
-/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -11,12 +11,18 @@
 #define LOADBALANCERS2_HPP
 
 #include <primecount-internal.hpp>
+#include <ElasticThreads.hpp>
 #include <int128_t.hpp>
 #include <macros.hpp>
 #include <OmpLock.hpp>
 #include <StatusS2.hpp>
+#include <ThreadGroups.hpp>
+#include <Vector.hpp>
+#include <WorkLog.hpp>
 
 #include <stdint.h>
+#include <atomic>
+#include <memory>
 
 namespace primecount {
 
@@ -28,6 +34,22 @@ struct ThreadData
   maxint_t sum = 0;
   double init_secs = 0;
   double secs = 0;
+  // Used by LoadBalancerS2 to run backup
+  // copies of straggler work units.
+  int slot = -1;
+  const std::atomic<bool>* cancel = nullptr;
+  bool cancelled = false;
+
+  /// Returns true if a backup copy of the current work unit
+  /// has already finished. Then the thread can stop working
+  /// on its work unit, its result will be discarded.
+  ///
+  bool is_cancelled()
+  {
+    if (cancel && cancel->load(std::memory_order_relaxed))
+      cancelled = true;
+    return cancelled;
+  }
 
   void start_time()
   {
@@ -59,6 +81,50 @@ public:
   maxint_t get_sum() const;
 
 private:
+  /// Work unit that is currently processed by a thread.
+  /// Near the end a straggler work unit may be run by a
+  /// 2nd (backup) thread, the first result wins.
+  struct Slot
+  {
+    WorkUnit unit = { 0, 0, 0 };
+    double start = 0;
+    bool is_busy = false;
+    // Slot of the thread that runs
+    // the same work unit, -1 if none.
+    int peer = -1;
+    // The peer has already finished
+    bool has_result = false;
+    maxint_t result = 0;
+    std::atomic<bool> cancel{false};
+  };
+
+  /// Thread group, see ThreadGroups.hpp. The backup copies
+  /// of a group's work units are run by the threads of the
+  /// same group.
+  struct Group
+  {
+    GroupChunk chunk;
+    int64_t segment_size = 0;
+    maxint_t sum = 0;
+    // Moving average of the work unit runtimes
+    double avg_secs = 0;
+    int max_slots = 0;
+    int used_slots = 0;
+    std::unique_ptr<Slot[]> slots;
+    bool is_mismatch = false;
+    // Finished work units that have not yet been
+    // added to the progress model.
+    Vector<ThreadData> finished;
+    OmpLock lock;
+  };
+
+  bool finish_unit(Group& group, ThreadData& thread);
+  bool get_chunk(int group);
+  bool get_group_unit(Group& group, ThreadData& thread);
+  bool steal_unit(int group, ThreadData& thread);
+  bool get_backup_unit(Group& group, ThreadData& thread);
+  void start_unit(Group& group, ThreadData& thread, const WorkUnit& unit);
+  void update_status(Group& group);
   void update_load_balancing(const ThreadData& thread);
   void update_number_of_segments(const ThreadData& thread);
   void update_segment_size();
@@ -74,10 +140,23 @@ private:
   maxint_t sum_approx_ = 0;
   double time_ = 0;
   bool is_print_ = false;
+  bool is_adaptive_ = true;
   StatusS2 status_;
+  WorkLog log_;
+  ThreadGroups thread_groups_;
+  std::unique_ptr<Group[]> groups_;
+  ElasticThreads elastic_;
   OmpLock lock_;
 };
 
+/// Minimum runtime in seconds of a straggler work
+/// unit before it is backed up, default 0.1.
+///
+void set_backup_threshold(double backup_secs);
+
+/// Number of backup work units run so far
+int64_t get_backup_units();
+
 } // namespace
 
 #endif
@@ -1,9 +1,10 @@
 ///
 /// @file   OmpLock.hpp
 /// @brief  The OmpLock and LockGuard classes are RAII-style
-///         wrappers for OpenMP locks.
+///         wrappers for OpenMP locks (or std::mutex if
+///         OpenMP is disabled).
 ///
-/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -19,16 +20,19 @@
   #include <omp.h>
 #else
 
-// If OpenMP is disabled we define the functions used by
-// the OmpLock and LockGuard classes as no-op.
+#include <mutex>
+
+// If OpenMP is disabled primecount uses std::thread (see
+// parallel.hpp), hence the OmpLock and LockGuard classes
+// use a std::mutex.
 namespace {
 
-using omp_lock_t = int;
+using omp_lock_t = std::mutex;
 
 inline void omp_init_lock(omp_lock_t*) { }
 inline void omp_destroy_lock(omp_lock_t*) { }
-inline void omp_set_lock(omp_lock_t*) { }
-inline void omp_unset_lock(omp_lock_t*) { }
+inline void omp_set_lock(omp_lock_t* lock) { lock->lock(); }
+inline void omp_unset_lock(omp_lock_t* lock) { lock->unlock(); }
 
 } // namespace
 
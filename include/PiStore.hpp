@@ -0,0 +1,44 @@
+///
+/// @file  PiStore.hpp
+/// @brief The pi(x) store is an optional file that contains the
+///        results of previous pi(x) computations. pi(x),
+///        nth_prime(n) and the internal pi(x) calls of the
+///        prime counting functions (e.g. pi(sqrt(x)) in P2)
+///        consult the store before computing pi(x) and append
+///        new results to it. Hence batch computations skip
+///        whole computations that have already been done, also
+///        across processes. Records are only appended (never
+///        modified) and the file is locked while reading and
+///        appending records, this way multiple primecount
+///        processes on the same host can share a store.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PISTORE_HPP
+#define PISTORE_HPP
+
+#include <int128_t.hpp>
+
+#include <stdint.h>
+#include <string>
+
+namespace primecount {
+
+bool is_pi_store();
+bool pi_store_lookup(maxint_t x, maxint_t& pix);
+bool nth_prime_store_lookup(int64_t n, int64_t& prime);
+
+/// @algorithm: Algorithm (and its parameters) used to
+///             compute pi(x) e.g. "gourdon alpha_y=...".
+///             "nth_prime" means that x is the nth prime
+///             with n = pix.
+///
+void pi_store_insert(maxint_t x, maxint_t pix, const std::string& algorithm);
+
+} // namespace
+
+#endif
@@ -23,6 +23,7 @@
 #include <Vector.hpp>
 
 #include <stdint.h>
+#include <cstddef>
 
 namespace primecount {
 
@@ -55,6 +56,15 @@ public:
     return count + popcnt64(bits & bitmask);
   }
 
+  /// Get number of primes <= xs[i] for i < n.
+  /// Faster than calling operator[] n times if
+  /// the CPU supports AVX512 VPOPCNTDQ.
+  ///
+  void lookup(const uint64_t* xs, std::size_t n, int64_t* out) const
+  {
+    pi_lookup(pi_.data(), 0, size(), xs, n, out);
+  }
+
   /// Get number of primes <= x
   static int64_t pi_cache(uint64_t x)
   {
@@ -68,12 +78,6 @@ public:
   }
 
 private:
-  struct pi_t
-  {
-    uint64_t count;
-    uint64_t bits;
-  };
-
   void init(uint64_t limit, uint64_t cache_limit, int threads);
   void init_bits(uint64_t low, uint64_t high, uint64_t thread_num);
   void init_count(uint64_t low, uint64_t high, uint64_t thread_num);
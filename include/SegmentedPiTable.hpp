@@ -18,7 +18,7 @@
 ///        the SegmentedPiTable are described in more detail in:
 ///        https://github.com/kimwalisch/primecount/blob/master/doc/Easy-Special-Leaves.md
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -33,6 +33,7 @@
 #include <popcnt.hpp>
 
 #include <stdint.h>
+#include <cstddef>
 #include <algorithm>
 
 namespace primecount {
@@ -84,16 +85,19 @@ public:
     return count + popcnt64(bits & bitmask);
   }
 
+  /// Get number of primes <= xs[i] for i < n.
+  /// Faster than calling operator[] n times if
+  /// the CPU supports AVX512 VPOPCNTDQ.
+  ///
+  void lookup(const uint64_t* xs, std::size_t n, int64_t* out) const
+  {
+    pi_lookup(pi_.data(), low_, high_ - low_, xs, n, out);
+  }
+
 private:
   void init_bits();
   void init_count(uint64_t pi_low);
 
-  struct pi_t
-  {
-    uint64_t count;
-    uint64_t bits;
-  };
-
   Vector<pi_t> pi_;
   uint64_t low_ = 0;
   uint64_t high_ = 0;
@@ -0,0 +1,144 @@
+///
+/// @file  SegmentedPrimes.hpp
+/// @brief The SegmentedPrimes class is a compressed array of the
+///        primes <= max for max > 2^32. Storing these primes in a
+///        Vector<int64_t> uses 8 bytes per prime, for our largest
+///        computations the primes array uses several gigabytes.
+///        SegmentedPrimes splits the primes array into blocks of
+///        2^16 primes, each block has a 64-bit base and each prime
+///        is stored as a 32-bit offset from its block's base. Hence
+///        SegmentedPrimes uses only slightly more than 4 bytes per
+///        prime and primes[i] is still an O(1) operation.
+///
+///        SegmentedPrimes has the same 1-indexing as the vectors
+///        returned by generate_primes() i.e. primes[1] = 2 and
+///        it can be used as the Primes template argument of the
+///        D, A and C formulas and of generate_phi().
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef SEGMENTEDPRIMES_HPP
+#define SEGMENTEDPRIMES_HPP
+
+#include <generate.hpp>
+#include <imath.hpp>
+#include <macros.hpp>
+#include <parallel.hpp>
+#include <primesieve.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+
+namespace primecount {
+
+template <typename T>
+class SegmentedPrimes
+{
+public:
+  using value_type = T;
+
+  /// Generate the primes <= max in parallel. The sieving
+  /// interval is split into chunks of at most 2^30 integers.
+  /// The 1st pass counts the primes of each chunk, then the
+  /// arrays are allocated (exactly) once and the 2nd pass
+  /// stores the primes of the chunks in parallel.
+  ///
+  SegmentedPrimes(int64_t max, int threads)
+  {
+    max = std::max(max, (int64_t) 0);
+    int64_t thread_threshold = (int64_t) 1e8;
+    threads = ideal_num_threads(max, threads, thread_threshold);
+    int64_t max_chunk_size = 1 << 30;
+    int64_t chunks = std::max(ceil_div(max + 1, max_chunk_size), (int64_t) threads);
+    int64_t chunk_size = ceil_div(max + 1, chunks);
+    Vector<int64_t> counts(chunks + 1);
+    counts[0] = 0;
+
+    parallel_for(threads, 0, chunks, 1, [&](int64_t i)
+    {
+      int64_t low = chunk_size * i;
+      int64_t high = std::min(low + chunk_size - 1, max);
+      counts[i + 1] = count_primes(low, high);
+    });
+
+    for (int64_t i = 0; i < chunks; i++)
+      counts[i + 1] += counts[i];
+
+    // primes[0] = 0
+    int64_t size = counts[chunks] + 1;
+    int64_t blocks = ceil_div(size, block_size);
+    offsets_.resize(size);
+    bases_.resize(blocks);
+    offsets_[0] = 0;
+
+    // The base of a block is the start of the chunk
+    // that contains the 1st prime of the block. The
+    // primes of a block are at most chunk_size + 2^16
+    // prime gaps larger than the base, hence their
+    // offsets fit into 32 bits.
+    for (int64_t b = 0, i = 0; b < blocks; b++)
+    {
+      int64_t first = b * block_size;
+      while (counts[i + 1] < first)
+        i++;
+      bases_[b] = (T) (chunk_size * i);
+    }
+
+    parallel_for(threads, 0, chunks, 1, [&](int64_t i)
+    {
+      int64_t low = chunk_size * i;
+      int64_t high = std::min(low + chunk_size - 1, max);
+      store_primes(low, high, counts[i] + 1);
+    });
+  }
+
+  uint64_t size() const
+  {
+    return offsets_.size();
+  }
+
+  ALWAYS_INLINE T operator[](uint64_t i) const
+  {
+    ASSERT(i < offsets_.size());
+    return bases_[i / block_size] + offsets_[i];
+  }
+
+private:
+  /// Store the primes inside [low, high],
+  /// the first prime is stored at index i.
+  ///
+  void store_primes(int64_t low, int64_t high, int64_t i)
+  {
+    if (low > high)
+      return;
+
+    primesieve::iterator it(low, high);
+    it.generate_next_primes();
+
+    for (; true; it.generate_next_primes())
+    {
+      for (std::size_t j = 0; j < it.size_; j++, i++)
+      {
+        uint64_t prime = it.primes_[j];
+        if ((int64_t) prime > high)
+          return;
+        uint64_t base = bases_[i / block_size];
+        ASSERT(prime - base <= 0xffffffffull);
+        offsets_[i] = (uint32_t) (prime - base);
+      }
+    }
+  }
+
+  static constexpr int64_t block_size = 1 << 16;
+  Vector<T> bases_;
+  Vector<uint32_t> offsets_;
+};
+
+} // namespace
+
+#endif
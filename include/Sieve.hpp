@@ -28,7 +28,7 @@
 ///        In-depth description of this algorithm:
 ///        https://github.com/kimwalisch/primecount/blob/master/doc/Hard-Special-Leaves.md
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -39,6 +39,7 @@
 
 #include <Vector.hpp>
 #include <stdint.h>
+#include <cstddef>
 
 namespace primecount {
 
@@ -46,6 +47,7 @@ class Sieve
 {
 public:
   Sieve(uint64_t low, uint64_t segment_size, uint64_t wheel_size);
+  ~Sieve();
   void cross_off(uint64_t prime, uint64_t i);
   void cross_off_count(uint64_t prime, uint64_t i);
   static uint64_t get_segment_size(uint64_t size);
@@ -57,8 +59,8 @@ public:
     return total_count_;
   }
 
-  template <typename T>
-  void pre_sieve(const Vector<T>& primes, uint64_t c, uint64_t low, uint64_t high)
+  template <typename Primes>
+  void pre_sieve(const Primes& primes, uint64_t c, uint64_t low, uint64_t high)
   {
     reset_sieve(low, high);
 
@@ -68,26 +70,38 @@ public:
     init_counter(low, high);
   }
 
+  /// Add the sieving primes[i] with i <= max_b to the sieve.
+  /// This is faster than adding the sieving primes one by one
+  /// when they are crossed off for the first time, because the
+  /// first multiples of a batch of sieving primes are computed
+  /// without 64-bit integer divisions.
+  ///
+  template <typename Primes>
+  void add_primes(const Primes& primes, uint64_t max_b)
+  {
+    uint64_t batch[batch_size];
+    uint64_t i = wheel_multiple_.size();
+
+    while (i <= max_b)
+    {
+      std::size_t n = 0;
+      for (; n < batch_size && i <= max_b; n++, i++)
+        batch[n] = primes[i];
+
+      add(batch, n);
+    }
+  }
+
 private:
   void add(uint64_t prime);
+  void add(const uint64_t* primes, std::size_t n);
+  void cross_off_count_dense(uint64_t prime, uint64_t i);
   void allocate_counter(uint64_t low);
   void init_counter(uint64_t low, uint64_t high);
   void reset_counter();
   void reset_sieve(uint64_t low, uint64_t high);
   uint64_t segment_size() const;
 
-  struct Wheel
-  {
-    uint32_t multiple;
-    uint32_t index;
-
-    Wheel() = default;
-    Wheel(uint32_t m, uint32_t i)
-      : multiple(m),
-        index(i)
-    { }
-  };
-
   struct Counter
   {
     uint64_t stop = 0;
@@ -113,8 +127,26 @@ private:
   uint64_t count_ = 0;
   uint64_t total_count_ = 0;
   Vector<uint8_t> sieve_;
-  Vector<Wheel> wheel_;
   Counter counter_;
+
+  // The wheel state of the sieving primes is split into a
+  // hot part and a cold part. The next multiple (hot) is
+  // accessed for each sieving prime in each segment, the
+  // wheel index (cold) is only accessed if the sieving
+  // prime has a multiple inside the current segment. For
+  // large b most sieving primes have no multiple inside
+  // the current segment and hence we only need to stream
+  // 4 bytes instead of 8 bytes per sieving prime.
+  Vector<uint32_t> wheel_multiple_;
+  Vector<uint8_t> wheel_index_;
+
+  // Number of sieving primes per add_primes() batch
+  static constexpr std::size_t batch_size = 64;
+
+  // Sieving primes < max_dense_prime are crossed off
+  // using the bit masks of their multiples.
+  static constexpr uint64_t max_dense_prime = 48;
+  Vector<uint64_t> pattern_;
 };
 
 } // namespace
@@ -1,7 +1,7 @@
 ///
 /// @file  StatusS2.hpp
 ///
-/// Copyright (C) 2021 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -10,26 +10,59 @@
 #ifndef STATUSS2_HPP
 #define STATUSS2_HPP
 
+#include <StatusThread.hpp>
 #include <int128_t.hpp>
 
+#include <stdint.h>
+#include <atomic>
+
 namespace primecount {
 
 class StatusS2
 {
 public:
-  StatusS2(maxint_t x);
+  StatusS2(maxint_t x, bool is_print = false);
   void print(int64_t b, int64_t max_b);
   void print(int64_t low, int64_t limit, maxint_t sum, maxint_t sum_approx);
   static double getPercent(int64_t low, int64_t limit, maxint_t sum, maxint_t sum_approx);
+  void add_work(int64_t low, int64_t dist, int64_t limit, double secs);
+  bool is_calibrated() const;
+  double getPercent(int64_t low, int64_t limit) const;
+  double getRemainingSecs(int64_t low, int64_t limit) const;
+  void set_threads(int threads) { threads_ = threads; }
 private:
-  void print(double percent);
+  bool is_publish();
+  void publish(double percent, double remaining_secs = -1);
+  void print_status();
+  void print(double percent, double remaining_secs);
+  double remaining_work(int64_t low, int64_t limit) const;
+  void fit(double& a, double& b) const;
+  // Least squares fit of:
+  // secs = a * leaf_weight + b * sieve_weight,
+  // see add_work()
+  double sum_ll_ = 0;
+  double sum_ls_ = 0;
+  double sum_ss_ = 0;
+  double sum_lt_ = 0;
+  double sum_st_ = 0;
+  double done_sieve_ = 0;
+  double done_secs_ = 0;
+  int64_t units_ = 0;
+  int threads_ = 1;
   double epsilon_ = 0;
   double percent_ = -1;
+  bool is_time_linear_ = false;
   double time_ = 0;
-  // Only print status if 0.1 seconds have elapsed
-  // since last printing the status.
-  double threshold_ = 0.1;
+  // Only publish the status if 0.01 seconds have
+  // elapsed since last publishing the status.
+  double threshold_ = 0.01;
   int precision_ = 0;
+  // Written by the worker threads,
+  // read by the status thread.
+  std::atomic<double> status_percent_{-1};
+  std::atomic<double> status_secs_{-1};
+  // Must be destroyed first
+  StatusThread thread_;
 };
 
 } // namespace
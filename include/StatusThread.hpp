@@ -0,0 +1,48 @@
+///
+/// @file  StatusThread.hpp
+/// @brief The StatusThread class prints the status of a computation
+///        from a background thread. The worker threads only publish
+///        their progress in atomic variables that are read by the
+///        status thread without locking. Hence worker threads never
+///        block on (slow) terminal I/O.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef STATUSTHREAD_HPP
+#define STATUSTHREAD_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace primecount {
+
+class StatusThread
+{
+public:
+  StatusThread() = default;
+  StatusThread(const StatusThread&) = delete;
+  StatusThread& operator=(const StatusThread&) = delete;
+  ~StatusThread();
+  void start(std::function<void()> print);
+  void stop();
+private:
+  void run();
+  std::function<void()> print_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool is_stop_ = false;
+  // Print the status every 0.1 seconds
+  std::chrono::milliseconds interval_{100};
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,140 @@
+///
+/// @file  ThreadGroups.hpp
+/// @brief Two-level load balancing for machines with many CPU
+///        cores. If the load balancers (LoadBalancerS2,
+///        LoadBalancerAC and LoadBalancerP2) used a single lock
+///        for handing out the work units, all threads would contend
+///        on the same cache line, which limits scaling on machines
+///        with hundreds of threads.
+///
+///        Hence the threads are partitioned into groups of
+///        consecutive thread numbers. Each group has its own lock
+///        and its own chunk of work that is split into work units
+///        locally. Only once a group's chunk is empty does a thread
+///        of that group acquire the global lock in order to fetch
+///        the next chunk. After all chunks have been handed out,
+///        idle threads steal the last work units of the chunks of
+///        other groups.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef THREADGROUPS_HPP
+#define THREADGROUPS_HPP
+
+#include <OmpLock.hpp>
+
+#include <stdint.h>
+
+namespace primecount {
+
+/// Work chunk of a thread group: [low, high[ is split
+/// into work units of unit_size. The threads of the group
+/// take the units from the front of the chunk, the threads
+/// of other groups steal units from the back.
+///
+struct GroupChunk
+{
+  int64_t low = 0;
+  int64_t high = 0;
+  int64_t unit_size = 0;
+
+  void assign(int64_t chunk_low,
+              int64_t chunk_high,
+              int64_t chunk_unit_size);
+
+  bool empty() const
+  {
+    return low >= high;
+  }
+
+  bool pop_front(int64_t& unit_low, int64_t& unit_high)
+  {
+    if (empty())
+      return false;
+
+    unit_low = low;
+    unit_high = (high - low > unit_size) ? low + unit_size : high;
+    low = unit_high;
+    return true;
+  }
+
+  /// The units are aligned to the start of the chunk
+  bool pop_back(int64_t& unit_low, int64_t& unit_high)
+  {
+    if (empty())
+      return false;
+
+    int64_t units = (high - low + unit_size - 1) / unit_size;
+    unit_low = low + (units - 1) * unit_size;
+    unit_high = high;
+    high = unit_low;
+    return true;
+  }
+};
+
+/// Thread group used by LoadBalancerAC and LoadBalancerP2
+struct ThreadGroup
+{
+  GroupChunk chunk;
+  OmpLock lock;
+};
+
+/// Steal the last work unit of the chunk of another thread
+/// group. This is only used near the end of the computation
+/// once all chunks have been handed out.
+///
+template <typename Group>
+bool steal_unit(Group* groups,
+                int size,
+                int group,
+                int64_t& low,
+                int64_t& high)
+{
+  for (int i = 1; i < size; i++)
+  {
+    Group& victim = groups[(group + i) % size];
+    LockGuard lockGuard(victim.lock);
+    if (victim.chunk.pop_back(low, high))
+      return true;
+  }
+
+  return false;
+}
+
+class ThreadGroups
+{
+public:
+  /// Partition threads into groups of
+  /// get_threads_per_group() threads.
+  void init(int threads, bool is_enabled = true);
+  /// Number of thread groups
+  int size() const { return groups_; }
+  /// Number of threads in the group
+  int threads(int group) const;
+  /// Group of the calling thread
+  int get_group() const;
+
+private:
+  int threads_ = 1;
+  int threads_per_group_ = 1;
+  int groups_ = 1;
+};
+
+/// The load balancers only use thread groups if
+/// there are more threads than threads per group.
+///
+void set_threads_per_group(int threads);
+int get_threads_per_group();
+
+/// Number of chunks with more than one work unit
+/// handed out so far, used for testing.
+///
+int64_t get_group_chunks();
+
+} // namespace
+
+#endif
@@ -0,0 +1,79 @@
+///
+/// @file  WarmCache.hpp
+/// @brief In server mode (primecount --stdin) many numbers are
+///        computed one after another by the same process. By
+///        default each computation allocates and initializes its
+///        PiTable, its primes array and its sieve buffers from
+///        scratch. If the warm cache is enabled these data
+///        structures are kept alive in between computations and
+///        they are only rebuilt if a larger x requires it.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef WARMCACHE_HPP
+#define WARMCACHE_HPP
+
+#include <PiTable.hpp>
+#include <Vector.hpp>
+#include <generate.hpp>
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+
+namespace primecount {
+
+void set_warm_cache(bool enable);
+bool is_warm_cache();
+
+/// Returns a PiTable whose size is >= max_x + 1. If the warm
+/// cache is enabled the PiTable is shared with previous and
+/// subsequent computations, it grows when a larger
+/// max_x is requested.
+///
+std::shared_ptr<const PiTable> get_pi_table(uint64_t max_x, int threads);
+
+/// The sieve buffers of the Sieve class are recycled
+/// using a pool of buffers. Each thread takes a buffer
+/// from the pool and puts it back once it is done.
+///
+void take_sieve_buffer(Vector<uint8_t>& sieve);
+void put_sieve_buffer(Vector<uint8_t>& sieve);
+
+/// Returns an array with the primes <= max_prime, primes[0] = 0.
+/// If the warm cache is enabled the array may contain additional
+/// primes > max_prime (up to the largest max_prime requested
+/// so far). Hence callers must not derive pi(max_prime)
+/// from the size of the primes array.
+///
+template <typename T>
+std::shared_ptr<const Vector<T>> get_primes(int64_t max_prime, int threads)
+{
+  if (!is_warm_cache())
+    return std::make_shared<const Vector<T>>(generate_primes<T>(max_prime, threads));
+
+  static std::mutex mutex;
+  static std::shared_ptr<const Vector<T>> primes;
+  static int64_t max_cached = -1;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (max_prime > max_cached)
+  {
+    // Free the old primes (unless they are still used
+    // by another thread) before allocating new ones.
+    primes.reset();
+    primes = std::make_shared<const Vector<T>>(generate_primes<T>(max_prime, threads));
+    max_cached = max_prime;
+  }
+
+  return primes;
+}
+
+} // namespace
+
+#endif
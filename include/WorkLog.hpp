@@ -0,0 +1,80 @@
+///
+/// @file  WorkLog.hpp
+/// @brief Record and replay the work units that the LoadBalancerS2
+///        and LoadBalancerAC classes assign to the threads. The
+///        LoadBalancerS2 adapts the size of the work units to the
+///        thread runtimes, hence it partitions the sieve interval
+///        differently in each run. For benchmarking small kernel
+///        optimizations this causes too much run-to-run variance.
+///        In record mode each load balancer appends its work units
+///        (in the order they have been handed out) to a log file
+///        and in replay mode each load balancer hands out exactly
+///        the same work units in the same order. In static mode the
+///        LoadBalancerS2 uses a deterministic partition that only
+///        depends on x and the number of threads.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef WORKLOG_HPP
+#define WORKLOG_HPP
+
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+
+namespace primecount {
+
+enum LoadBalancingMode
+{
+  LOAD_BALANCING_ADAPTIVE,
+  LOAD_BALANCING_RECORD,
+  LOAD_BALANCING_REPLAY,
+  LOAD_BALANCING_STATIC
+};
+
+/// The LoadBalancerAC hands out [low, high[,
+/// this is stored as segments = 1 and
+/// segment_size = high - low.
+///
+struct WorkUnit
+{
+  int64_t low;
+  int64_t segments;
+  int64_t segment_size;
+};
+
+class WorkLog
+{
+public:
+  /// @name:  Name of the load balancer e.g. "LoadBalancerS2".
+  /// @limit: Sieve limit of the load balancer, used to
+  ///         detect replaying a log of a different x.
+  ///
+  WorkLog(const std::string& name, int64_t limit);
+  ~WorkLog();
+  bool is_record() const { return mode_ == LOAD_BALANCING_RECORD; }
+  bool is_replay() const { return mode_ == LOAD_BALANCING_REPLAY; }
+  void record(const WorkUnit& unit);
+  bool replay(WorkUnit& unit);
+
+private:
+  std::string name_;
+  int64_t limit_ = 0;
+  std::size_t next_ = 0;
+  Vector<WorkUnit> units_;
+  std::ofstream file_;
+  LoadBalancingMode mode_;
+};
+
+void set_load_balancing(LoadBalancingMode mode, const std::string& filename = "");
+LoadBalancingMode get_load_balancing();
+
+} // namespace
+
+#endif
@@ -10,22 +10,155 @@
 #ifndef GENERATE_HPP
 #define GENERATE_HPP
 
+#include <primecount-internal.hpp>
 #include <primesieve.hpp>
+#include <imath.hpp>
+#include <parallel.hpp>
 #include <Vector.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <cmath>
 
 namespace primecount {
 
+namespace {
+
+/// Upper bound for the number of primes <= x.
+/// pi(x) < 1.25506 * x / log(x) for x > 1.
+/// Rosser & Schoenfeld, Approximate formulas
+/// for some functions of prime numbers, 1962.
+///
+inline int64_t pi_upper_bound(int64_t x)
+{
+  if (x < 17)
+    return 7;
+
+  double n = (double) x;
+  return (int64_t) (1.25506 * n / std::log(n)) + 1;
+}
+
+/// Upper bound for the nth prime.
+/// p_n < n * (log(n) + log(log(n))) for n >= 6.
+/// Rosser, The n-th prime is greater than n log n, 1939.
+///
+inline int64_t nth_prime_upper_bound(int64_t n)
+{
+  if (n < 6)
+    return 13;
+
+  double x = (double) n;
+  double logx = std::log(x);
+  return (int64_t) (x * (logx + std::log(logx))) + 1;
+}
+
+/// Count the primes inside [low, high]
+inline int64_t count_primes(int64_t low, int64_t high)
+{
+  if (low > high)
+    return 0;
+
+  int64_t count = 0;
+  primesieve::iterator it(low, high);
+  it.generate_next_primes();
+
+  // Count the primes of the iterator's internal primes
+  // array, this is much faster than calling
+  // it.next_prime() for each prime.
+  for (; (int64_t) it.primes_[it.size_ - 1] <= high; it.generate_next_primes())
+    count += it.size_;
+
+  uint64_t* end = it.primes_ + it.size_;
+  count += std::upper_bound(it.primes_, end, (uint64_t) high) - it.primes_;
+  return count;
+}
+
+/// Store the primes inside [low, high] into primes[0 .. n[.
+/// Stops once n primes have been stored.
+///
+template <typename T>
+void store_primes(int64_t low, int64_t high, T* primes, int64_t n)
+{
+  if (low > high || n <= 0)
+    return;
+
+  int64_t i = 0;
+  primesieve::iterator it(low, high);
+  it.generate_next_primes();
+
+  while (true)
+  {
+    for (std::size_t j = 0; j < it.size_; j++)
+    {
+      if ((int64_t) it.primes_[j] > high || i >= n)
+        return;
+      primes[i++] = (T) it.primes_[j];
+    }
+
+    it.generate_next_primes();
+  }
+}
+
+/// Generate the primes <= max in parallel. The first
+/// pass counts the primes of each thread's interval, then
+/// the primes vector is allocated (exactly) once and the
+/// second pass fills the threads' slices in parallel.
+/// If n >= 0 only the first n primes are stored.
+///
+template <typename T>
+Vector<T> generate_primes_parallel(int64_t max, int64_t n, int threads)
+{
+  Vector<int64_t> counts(threads + 1);
+  int64_t thread_dist = ceil_div(max + 1, threads);
+
+  parallel_for(threads, 0, threads, 1, [&](int64_t t)
+  {
+    int64_t low = thread_dist * t;
+    int64_t high = std::min(low + thread_dist - 1, max);
+    counts[t + 1] = count_primes(low, high);
+  });
+
+  counts[0] = 0;
+  for (int t = 0; t < threads; t++)
+    counts[t + 1] += counts[t];
+
+  int64_t size = counts[threads];
+  if (n >= 0)
+    size = std::min(size, n);
+
+  Vector<T> primes(size + 1);
+  primes[0] = 0;
+
+  parallel_for(threads, 0, threads, 1, [&](int64_t t)
+  {
+    int64_t low = thread_dist * t;
+    int64_t high = std::min(low + thread_dist - 1, max);
+    int64_t thread_size = std::min(counts[t + 1], size) - counts[t];
+    store_primes(low, high, &primes[counts[t] + 1], thread_size);
+  });
+
+  return primes;
+}
+
+} // namespace
+
 /// Generate a vector with the primes <= max.
 /// The primes vector uses 1-indexing i.e. primes[1] = 2.
 ///
 template <typename T>
-Vector<T> generate_primes(int64_t max)
+Vector<T> generate_primes(int64_t max, int threads = 1)
 {
+  int64_t thread_threshold = (int64_t) 1e8;
+  threads = ideal_num_threads(max, threads, thread_threshold);
+
+  if (threads > 1)
+    return generate_primes_parallel<T>(max, -1, threads);
+
+  // Reserve enough memory to avoid reallocations, the
+  // pages of the unused capacity are never touched.
   Vector<T> primes;
-  primes.resize(1);
-  primes[0] = 0;
+  primes.reserve(pi_upper_bound(max) + 1);
+  primes.push_back(0);
   primesieve::generate_primes(max, &primes);
   return primes;
 }
@@ -34,8 +167,15 @@ Vector<T> generate_primes(int64_t max)
 /// The primes vector uses 1-indexing i.e. primes[1] = 2.
 //
 template <typename T>
-Vector<T> generate_n_primes(int64_t n)
+Vector<T> generate_n_primes(int64_t n, int threads = 1)
 {
+  int64_t max = nth_prime_upper_bound(n);
+  int64_t thread_threshold = (int64_t) 1e8;
+  threads = ideal_num_threads(max, threads, thread_threshold);
+
+  if (threads > 1)
+    return generate_primes_parallel<T>(max, n, threads);
+
   Vector<T> primes;
   primes.reserve(n + 1);
   primes.push_back(0);
@@ -16,7 +16,7 @@
 ///        method, Revista do DETUA, vol. 4, no. 6, March 2006, p. 761.
 ///        http://sweet.ua.pt/tos/bib/5.4.pdf
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -204,8 +204,9 @@ private:
   int64_t phi_cache(uint64_t x, uint64_t a) const
   {
     ASSERT(is_cached(x, a));
-    uint64_t count = sieve_[a][x / 240].count;
-    uint64_t bits = sieve_[a][x / 240].bits;
+    uint64_t i = x / 240;
+    uint64_t count = counts_[a][i / block_size] + sieve_[a][i].count;
+    uint64_t bits = sieve_[a][i].bits;
     uint64_t bitmask = unset_larger_[x % 240];
     return count + popcnt64(bits & bitmask);
   }
@@ -227,6 +228,7 @@ private:
     {
       ASSERT(max_a_ >= 3);
       sieve_.resize(max_a_ + 1);
+      counts_.resize(max_a_ + 1);
       sieve_[3].resize(max_x_size_);
       std::fill(sieve_[3].begin(), sieve_[3].end(), sieve_t{0, ~0ull});
       max_a_cached_ = 3;
@@ -260,13 +262,23 @@ private:
       if (i > PhiTiny::max_a())
       {
         // Fill an array with the cumulative 1 bit counts.
-        // sieve[i][j] contains the count of numbers < j * 240 that
-        // are not divisible by any of the first i primes.
+        // counts[i][j / block_size] + sieve[i][j].count contains
+        // the count of numbers < j * 240 that are not divisible
+        // by any of the first i primes.
         uint64_t count = 0;
-        for (auto& sieve : sieve_[i])
+        uint64_t block_count = 0;
+        counts_[i].resize(ceil_div(max_x_size_, block_size));
+
+        for (uint64_t j = 0; j < max_x_size_; j++)
         {
-          sieve.count = (uint32_t) count;
-          count += popcnt64(sieve.bits);
+          if (j % block_size == 0)
+          {
+            block_count = count;
+            counts_[i][j / block_size] = (uint32_t) count;
+          }
+
+          sieve_[i][j].count = (uint16_t) (count - block_count);
+          count += popcnt64(sieve_[i][j].bits);
         }
       }
     }
@@ -277,21 +289,30 @@ private:
   uint64_t max_a_cached_ = 0;
   uint64_t max_a_ = 0;
 
+  /// A block of block_size sieve array elements contains
+  /// 2^16 bits, hence sieve_t.count fits into 16 bits if
+  /// it is stored relative to the start of its block.
+  static constexpr uint64_t block_size = 1 << 10;
+
   /// Packing sieve_t increases the cache's capacity by 25%
-  /// which improves performance by up to 10%.
+  /// which improves performance by up to 10%. Storing the
+  /// count relative to its block (16-bit instead of 32-bit)
+  /// increases the cache's capacity by another 20%.
   #pragma pack(push, 1)
   struct sieve_t
   {
-    uint32_t count;
+    uint16_t count;
     uint64_t bits;
   };
   #pragma pack(pop)
 
   /// sieve[a] contains only numbers that are not divisible
-  /// by any of the the first a primes. sieve[a][i].count
-  /// contains the count of numbers < i * 240 that are not
-  /// divisible by any of the first a primes.
+  /// by any of the the first a primes. counts[a][i / block_size]
+  /// + sieve[a][i].count contains the count of numbers < i * 240
+  /// that are not divisible by any of the first a primes. The
+  /// counts[a] arrays are tiny and usually in the CPU cache.
   Vector<Vector<sieve_t>> sieve_;
+  Vector<Vector<uint32_t>> counts_;
   const Primes& primes_;
   const PiTable& pi_;
 };
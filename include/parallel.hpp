@@ -0,0 +1,263 @@
+///
+/// @file  parallel.hpp
+/// @brief Multi-threading primitives used by primecount's parallel
+///        algorithms. If primecount is compiled with OpenMP these
+///        functions are implemented using OpenMP, else they are
+///        implemented using std::thread. Hence primecount also
+///        scales on toolchains that do not support OpenMP, e.g.
+///        static musl builds.
+///
+///        parallel(threads, f):
+///        Run f(thread_num) on threads threads, thread_num = 0
+///        is the calling (master) thread.
+///
+///        parallel_sum<T>(threads, f):
+///        Same as parallel() but returns the sum of the values
+///        returned by each thread's f(thread_num).
+///
+///        parallel_for(threads, start, stop, chunk_size, f):
+///        for (i = start; i < stop; i++) f(i); The iterations are
+///        distributed dynamically in chunks of chunk_size.
+///
+///        parallel_for_sum<T>(threads, start, stop, chunk_size, f):
+///        Same as parallel_for() but returns the sum of f(i).
+///
+///        get_thread_num():
+///        Returns the thread_num of the calling thread inside of
+///        parallel(), used by the load balancers to find the
+///        thread group of the calling thread.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+
+#if defined(_OPENMP)
+  #include <omp.h>
+#else
+  #include <atomic>
+  #include <exception>
+  #include <mutex>
+  #include <thread>
+  #include <vector>
+#endif
+
+namespace primecount {
+
+#if defined(_OPENMP)
+
+/// Max number of threads supported by the backend
+inline int get_max_threads()
+{
+  return std::max(1, omp_get_max_threads());
+}
+
+inline int get_thread_num()
+{
+  return omp_get_thread_num();
+}
+
+template <typename F>
+void parallel(int threads, F&& f)
+{
+  #pragma omp parallel num_threads(threads)
+  f(omp_get_thread_num());
+}
+
+template <typename T, typename F>
+T parallel_sum(int threads, F&& f)
+{
+  T sum = 0;
+
+  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  sum += f(omp_get_thread_num());
+
+  return sum;
+}
+
+template <typename F>
+void parallel_for(int threads,
+                  int64_t start,
+                  int64_t stop,
+                  int64_t chunk_size,
+                  F&& f)
+{
+  chunk_size = std::max(chunk_size, (int64_t) 1);
+  #pragma omp parallel for schedule(dynamic, chunk_size) num_threads(threads)
+  for (int64_t i = start; i < stop; i++)
+    f(i);
+}
+
+template <typename T, typename F>
+T parallel_for_sum(int threads,
+                   int64_t start,
+                   int64_t stop,
+                   int64_t chunk_size,
+                   F&& f)
+{
+  chunk_size = std::max(chunk_size, (int64_t) 1);
+  T sum = 0;
+
+  #pragma omp parallel for schedule(dynamic, chunk_size) num_threads(threads) reduction(+: sum)
+  for (int64_t i = start; i < stop; i++)
+    sum += f(i);
+
+  return sum;
+}
+
+#else
+
+/// Max number of threads supported by the backend
+inline int get_max_threads()
+{
+  return (int) std::max(1u, std::thread::hardware_concurrency());
+}
+
+/// thread_num of the calling thread
+/// inside of the current parallel().
+///
+inline int& thread_num_ref()
+{
+  thread_local int thread_num = 0;
+  return thread_num;
+}
+
+inline int get_thread_num()
+{
+  return thread_num_ref();
+}
+
+/// The calling thread runs f(0), the other threads are
+/// created using std::thread. If a thread throws an
+/// exception the exception is rethrown by the calling
+/// thread after all threads have finished.
+///
+template <typename F>
+void parallel(int threads, F&& f)
+{
+  // parallel() may be nested, hence the calling
+  // thread restores its previous thread_num.
+  int old_thread_num = get_thread_num();
+
+  if (threads <= 1)
+  {
+    thread_num_ref() = 0;
+    f(0);
+    thread_num_ref() = old_thread_num;
+    return;
+  }
+
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+
+  auto run = [&](int thread_num)
+  {
+    thread_num_ref() = thread_num;
+
+    try {
+      f(thread_num);
+    }
+    catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error)
+        error = std::current_exception();
+    }
+  };
+
+  for (int t = 1; t < threads; t++)
+    pool.emplace_back(run, t);
+
+  run(0);
+  thread_num_ref() = old_thread_num;
+
+  for (std::thread& thread : pool)
+    thread.join();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+template <typename T, typename F>
+T parallel_sum(int threads, F&& f)
+{
+  threads = std::max(threads, 1);
+  Vector<T> sums(threads);
+
+  parallel(threads, [&](int thread_num) {
+    sums[thread_num] = f(thread_num);
+  });
+
+  T sum = 0;
+  for (const T& n : sums)
+    sum += n;
+
+  return sum;
+}
+
+/// Dynamic scheduling using a relaxed atomic counter,
+/// the chunks are handed out in sequential order.
+///
+template <typename F>
+void parallel_for(int threads,
+                  int64_t start,
+                  int64_t stop,
+                  int64_t chunk_size,
+                  F&& f)
+{
+  chunk_size = std::max(chunk_size, (int64_t) 1);
+  std::atomic<int64_t> next(start);
+
+  parallel(threads, [&](int) {
+    for (int64_t low = next.fetch_add(chunk_size, std::memory_order_relaxed);
+         low < stop;
+         low = next.fetch_add(chunk_size, std::memory_order_relaxed))
+    {
+      int64_t high = std::min(low + chunk_size, stop);
+      for (int64_t i = low; i < high; i++)
+        f(i);
+    }
+  });
+}
+
+template <typename T, typename F>
+T parallel_for_sum(int threads,
+                   int64_t start,
+                   int64_t stop,
+                   int64_t chunk_size,
+                   F&& f)
+{
+  chunk_size = std::max(chunk_size, (int64_t) 1);
+  std::atomic<int64_t> next(start);
+
+  return parallel_sum<T>(threads, [&](int) {
+    T sum = 0;
+
+    for (int64_t low = next.fetch_add(chunk_size, std::memory_order_relaxed);
+         low < stop;
+         low = next.fetch_add(chunk_size, std::memory_order_relaxed))
+    {
+      int64_t high = std::min(low + chunk_size, stop);
+      for (int64_t i = low; i < high; i++)
+        sum += f(i);
+    }
+
+    return sum;
+  });
+}
+
+#endif
+
+} // namespace
+
+#endif
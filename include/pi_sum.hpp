@@ -0,0 +1,67 @@
+///
+/// @file  pi_sum.hpp
+/// @brief The easy special leaves and the A formula spend most of
+///        their time in loops of the form:
+///
+///        for (i = start; i < stop; i++)
+///          sum += pi[x / primes[i]];
+///
+///        pi_sum() computes these sums using batches of x values
+///        that are looked up using PiTable::lookup() (or
+///        SegmentedPiTable::lookup()). The batch lookup uses
+///        AVX512 gather and VPOPCNTDQ instructions if the CPU
+///        supports them.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PI_SUM_HPP
+#define PI_SUM_HPP
+
+#include <macros.hpp>
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace primecount {
+
+/// Returns the sum of pi[get_x(i)] for start <= i < stop.
+/// @pi: PiTable or SegmentedPiTable.
+///
+template <typename T,
+          typename PiTable,
+          typename F>
+ALWAYS_INLINE T pi_sum(const PiTable& pi,
+                       uint64_t start,
+                       uint64_t stop,
+                       F get_x)
+{
+  constexpr uint64_t batch_size = 64;
+  uint64_t xs[batch_size];
+  int64_t pis[batch_size];
+  T sum = 0;
+
+  while (start < stop)
+  {
+    uint64_t n = stop - start;
+    n = (n < batch_size) ? n : batch_size;
+
+    for (uint64_t j = 0; j < n; j++)
+      xs[j] = get_x(start + j);
+
+    pi.lookup(xs, (std::size_t) n, pis);
+    start += n;
+
+    for (uint64_t j = 0; j < n; j++)
+      sum += pis[j];
+  }
+
+  return sum;
+}
+
+} // namespace
+
+#endif
@@ -1,9 +1,10 @@
 ///
 /// @file  primecount-config.hpp
-/// @brief Default CPU cache sizes and maximum CPU cache line size
-///        that will be used by primecount's algorithms.
+/// @brief Default CPU cache sizes, maximum CPU cache line size and
+///        thread group size that will be used by primecount's
+///        algorithms.
 ///
-/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -27,6 +28,17 @@
   #define L2_CACHE_SIZE (512 << 10)
 #endif
 
+#ifndef THREADS_PER_GROUP
+  /// Default number of threads per thread group. On machines with
+  /// many CPU cores the load balancers hand out large chunks of work
+  /// to groups of threads (ideally the threads of a NUMA node or of
+  /// an L3 cache domain) and the threads of a group split their
+  /// chunk into work units locally. Consecutive thread numbers are
+  /// assigned to the same group, use OMP_PROC_BIND=close to pin
+  /// them to nearby CPU cores.
+  #define THREADS_PER_GROUP 32
+#endif
+
 #ifndef MAX_CACHE_LINE_SIZE
   /// Maximum CPU cache line size in bytes (of all CPU types that
   /// will be produced over the next few decades).
@@ -2,7 +2,7 @@
 /// @file  primecount-internal.hpp
 /// @brief primecount internal functions
 ///
-/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -31,12 +31,14 @@ int64_t pi_lmo2(int64_t x);
 int64_t pi_lmo3(int64_t x);
 int64_t pi_lmo4(int64_t x);
 int64_t pi_primesieve(int64_t x);
+maxint_t prime_sum_primesieve(int64_t x);
 
 std::string pi(const std::string& x, int threads);
 int64_t pi(int64_t x, int threads);
 int64_t pi_noprint(int64_t x, int threads);
 int64_t pi_deleglise_rivat(int64_t x, int threads);
 int64_t nth_prime(int64_t n, int threads);
+maxint_t prime_sum(int64_t x, int threads);
 
 int64_t pi_cache(int64_t x, bool print = is_print());
 int64_t pi_deleglise_rivat_64(int64_t x, int threads, bool print = is_print());
@@ -44,7 +46,11 @@ int64_t pi_legendre(int64_t x, int threads, bool print = is_print());
 int64_t pi_lehmer(int64_t x, int threads, bool print = is_print());
 int64_t pi_lmo5(int64_t x, bool print = is_print());
 int64_t pi_lmo_parallel(int64_t x, int threads, bool print = is_print());
+int64_t pi_lmo_mod(int64_t x, int64_t q, int64_t a, int threads, bool print = is_print());
 int64_t pi_meissel(int64_t x, int threads, bool print = is_print());
+int64_t semiprime_count(int64_t x, int threads, bool print = is_print());
+int64_t mertens(int64_t x, int threads, bool print = is_print());
+maxint_t prime_sum_lmo(int64_t x, int threads, bool print = is_print());
 int64_t phi(int64_t x, int64_t a, int threads, bool print = is_print());
 int64_t P2(int64_t x, int64_t y, int64_t a, int threads, bool print = is_print());
 int64_t P3(int64_t x, int64_t y, int64_t a, int threads, bool print = is_print());
@@ -59,7 +65,14 @@ int64_t RiemannR_inverse(int64_t);
   int128_t pi(int128_t x, int threads);
   int128_t pi_deleglise_rivat(int128_t x, int threads);
   int128_t pi_deleglise_rivat_128(int128_t x, int threads, bool print = is_print());
+  int128_t pi_lmo_parallel(int128_t x, int threads, bool print = is_print());
+  int128_t pi_lmo_parallel_128(int128_t x, int threads, bool print = is_print());
   int128_t P2(int128_t x, int64_t y, int64_t a, int threads, bool print = is_print());
+  int128_t semiprime_count(int128_t x, int threads, bool print = is_print());
+  int128_t mertens(int128_t x, int threads, bool print = is_print());
+  int128_t prime_sum(int128_t x, int threads);
+  int128_t prime_sum_lmo(int128_t x, int threads, bool print = is_print());
+  int128_t prime_sum_lmo_128(int128_t x, int threads, bool print = is_print());
 
   int128_t Li(int128_t);
   int128_t Li_inverse(int128_t);
@@ -82,6 +95,7 @@ int64_t get_x_star_gourdon(maxint_t x, int64_t y);
 maxint_t get_max_x(double alpha_y);
 maxint_t to_maxint(const std::string& expr);
 double get_time();
+double get_time_coarse();
 
 } // namespace primecount
 
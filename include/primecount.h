@@ -5,7 +5,7 @@
  *        optimized implementations of the combinatorial type
  *        prime counting function algorithms.
  *
- * Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+ * Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
  *
  * This file is distributed under the BSD License.
  */
@@ -54,6 +54,19 @@ int64_t primecount_pi(int64_t x);
  */
 int primecount_pi_str(const char* x, char* res, size_t len);
 
+/*
+ * Count the number of primes <= x that are congruent
+ * to a modulo q, i.e. p ≡ a (mod q), using the
+ * Lagarias-Miller-Odlyzko algorithm.
+ * Uses all CPU cores by default.
+ * @pre 1 <= q <= 1000
+ * Returns -1 if an error occurs.
+ * 
+ * Run time: O(x^(2/3) * q)
+ * Memory usage: O(x^(1/3) * (log x)^2 + pi(x^(1/3)) * q * threads)
+ */
+int64_t primecount_pi_mod(int64_t x, int64_t q, int64_t a);
+
 /*
  * Partial sieve function (a.k.a. Legendre-sum).
  * phi(x, a) counts the numbers <= x that are not divisible
@@ -73,6 +86,90 @@ int64_t primecount_phi(int64_t x, int64_t a);
  */
 int64_t primecount_nth_prime(int64_t n);
 
+/*
+ * Count the semiprimes <= x, i.e. the numbers <= x that
+ * are the product of exactly 2 prime factors.
+ * Uses all CPU cores by default.
+ * Returns -1 if an error occurs.
+ * 
+ * Run time: O(x^(16/21) / (log x)^2)
+ * Memory usage: O(x^(1/2))
+ */
+int64_t primecount_semiprime_count(int64_t x);
+
+/*
+ * 128-bit semiprime counting function.
+ * Count the semiprimes <= x, i.e. the numbers <= x that
+ * are the product of exactly 2 prime factors.
+ * Uses all CPU cores by default.
+ * 
+ * @param x    Null-terminated string integer e.g. "12345".
+ *             Note that x must be <= primecount_get_max_x() which is
+ *             10^31 on 64-bit systems and 2^63-1 on 32-bit systems.
+ * @param res  Result output buffer.
+ * @param len  Length of the res buffer. The length must be sufficiently
+ *             large to fit the result, 32 is always enough.
+ * @return     Returns -1 if an error occurs, else returns the number
+ *             of characters (>= 1) that have been written to the
+ *             res buffer, not counting the terminating null character.
+ * 
+ * Run time: O(x^(16/21) / (log x)^2)
+ * Memory usage: O(x^(1/2))
+ */
+int primecount_semiprime_count_str(const char* x, char* res, size_t len);
+
+/*
+ * Compute the Mertens function M(x), the sum of the
+ * Moebius function values mu(n) with n <= x.
+ * Uses all CPU cores by default.
+ * Returns INT64_MIN if an error occurs.
+ * 
+ * Run time: O(x^(2/3) log log x)
+ * Memory usage: O(x^(1/3))
+ */
+int64_t primecount_mertens(int64_t x);
+
+/*
+ * 128-bit Mertens function.
+ * Compute M(x), the sum of the Moebius function
+ * values mu(n) with n <= x.
+ * Uses all CPU cores by default.
+ * 
+ * @param x    Null-terminated string integer e.g. "12345".
+ *             Note that x must be <= 10^27.
+ * @param res  Result output buffer.
+ * @param len  Length of the res buffer. The length must be sufficiently
+ *             large to fit the result, 32 is always enough.
+ * @return     Returns -1 if an error occurs, else returns the number
+ *             of characters (>= 1) that have been written to the
+ *             res buffer, not counting the terminating null character.
+ * 
+ * Run time: O(x^(2/3) log log x)
+ * Memory usage: O(x^(1/3))
+ */
+int primecount_mertens_str(const char* x, char* res, size_t len);
+
+/*
+ * Compute the sum of the primes <= x using a weighted
+ * variant of the Lagarias-Miller-Odlyzko algorithm.
+ * Uses all CPU cores by default.
+ * 
+ * @param x    Null-terminated string integer e.g. "12345".
+ *             Note that x must be <= 1.2 * 10^20 on 64-bit systems
+ *             and <= 10^10 on 32-bit systems, for larger x the
+ *             prime sum does not fit into a signed 128-bit integer.
+ * @param res  Result output buffer.
+ * @param len  Length of the res buffer. The length must be sufficiently
+ *             large to fit the result, 48 is always enough.
+ * @return     Returns -1 if an error occurs, else returns the number
+ *             of characters (>= 1) that have been written to the
+ *             res buffer, not counting the terminating null character.
+ * 
+ * Run time: O(x^(2/3))
+ * Memory usage: O(x^(1/3) * (log x)^2)
+ */
+int primecount_prime_sum_str(const char* x, char* res, size_t len);
+
 /*
  * Largest number supported by primecount_pi_str(x).
  * @return 64-bit CPUs: 10^31,
@@ -5,7 +5,7 @@
 ///        optimized implementations of the combinatorial type
 ///        prime counting function algorithms.
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License.
 ///
@@ -54,6 +54,18 @@ int64_t pi(int64_t x);
 ///
 std::string pi(const std::string& x);
 
+/// Count the number of primes <= x that are congruent
+/// to a modulo q, i.e. p ≡ a (mod q), using the
+/// Lagarias-Miller-Odlyzko algorithm.
+/// Uses all CPU cores by default.
+/// @pre 1 <= q <= 1000
+/// Throws a primecount_error if an error occurs.
+///
+/// Run time: O(x^(2/3) * q)
+/// Memory usage: O(x^(1/3) * (log x)^2 + pi(x^(1/3)) * q * threads)
+///
+int64_t pi(int64_t x, int64_t q, int64_t a);
+
 /// Partial sieve function (a.k.a. Legendre-sum).
 /// phi(x, a) counts the numbers <= x that are not divisible
 /// by any of the first a primes.
@@ -71,6 +83,120 @@ int64_t phi(int64_t x, int64_t a);
 ///
 int64_t nth_prime(int64_t n);
 
+/// Count the semiprimes <= x, i.e. the numbers <= x that
+/// are the product of exactly 2 prime factors.
+/// Uses all CPU cores by default.
+/// Throws a primecount_error if an error occurs.
+///
+/// Run time: O(x^(16/21) / (log x)^2)
+/// Memory usage: O(x^(1/2))
+///
+int64_t semiprime_count(int64_t x);
+
+/// 128-bit semiprime counting function.
+/// Count the semiprimes <= x, i.e. the numbers <= x that
+/// are the product of exactly 2 prime factors.
+/// Uses all CPU cores by default.
+///
+/// @param x Null-terminated string integer e.g. "12345".
+///          Note that x must be <= get_max_x() which is 10^31 on
+///          64-bit systems and 2^63-1 on 32-bit systems.
+/// Throws a primecount_error if an error occurs.
+///
+/// Run time: O(x^(16/21) / (log x)^2)
+/// Memory usage: O(x^(1/2))
+///
+std::string semiprime_count(const std::string& x);
+
+/// Compute the Mertens function M(x), the sum of the
+/// Moebius function values mu(n) with n <= x.
+/// Uses all CPU cores by default.
+/// Throws a primecount_error if an error occurs.
+///
+/// Run time: O(x^(2/3) log log x)
+/// Memory usage: O(x^(1/3))
+///
+int64_t mertens(int64_t x);
+
+/// 128-bit Mertens function.
+/// Compute M(x), the sum of the Moebius function
+/// values mu(n) with n <= x.
+/// Uses all CPU cores by default.
+///
+/// @param x Null-terminated string integer e.g. "12345".
+///          Note that x must be <= 10^27.
+/// Throws a primecount_error if an error occurs.
+///
+/// Run time: O(x^(2/3) log log x)
+/// Memory usage: O(x^(1/3))
+///
+std::string mertens(const std::string& x);
+
+/// Compute the sum of the primes <= x using a weighted
+/// variant of the Lagarias-Miller-Odlyzko algorithm.
+/// The result is returned as a string because
+/// it does not fit into a 64-bit integer.
+/// Uses all CPU cores by default.
+/// @pre x <= 10^10 on 32-bit systems.
+/// Throws a primecount_error if an error occurs.
+///
+/// Run time: O(x^(2/3))
+/// Memory usage: O(x^(1/3) * (log x)^2)
+///
+std::string prime_sum(int64_t x);
+
+/// 128-bit version of prime_sum(x).
+/// Compute the sum of the primes <= x using a weighted
+/// variant of the Lagarias-Miller-Odlyzko algorithm.
+/// Uses all CPU cores by default.
+///
+/// @param x Null-terminated string integer e.g. "12345".
+///          Note that x must be <= 1.2 * 10^20 on 64-bit
+///          systems and <= 10^10 on 32-bit systems, for
+///          larger x the prime sum does not fit into a
+///          signed 128-bit integer.
+/// Throws a primecount_error if an error occurs.
+///
+/// Run time: O(x^(2/3))
+/// Memory usage: O(x^(1/3) * (log x)^2)
+///
+std::string prime_sum(const std::string& x);
+
+/// pi_iterator computes pi(x) for a sequence of nearby x
+/// values. The first pi(x) is computed using the prime counting
+/// function, then each call to advance_to(x) only counts the
+/// primes between the previous x and the new x using the
+/// segmented sieve of Eratosthenes. If x moves so far that
+/// sieving would take longer than computing pi(x) from
+/// scratch, pi(x) is computed from scratch instead.
+/// Throws a primecount_error if an error occurs.
+///
+class pi_iterator
+{
+public:
+  /// Initialize the iterator at x, computes pi(x).
+  /// Uses all CPU cores by default.
+  pi_iterator(int64_t x = 0);
+  pi_iterator(int64_t x, int threads);
+
+  /// Move the iterator to x and return pi(x).
+  /// x may be larger (forward) or smaller (reverse)
+  /// than the current x.
+  ///
+  int64_t advance_to(int64_t x);
+
+  /// Current x
+  int64_t get_x() const { return x_; }
+
+  /// pi(get_x())
+  int64_t get_pi() const { return pi_; }
+
+private:
+  int64_t x_;
+  int64_t pi_;
+  int threads_;
+};
+
 /// Largest number supported by pi(const std::string& x).
 /// @return 64-bit CPUs: 10^31,
 ///         32-bit CPUs: 2^63-1.
@@ -85,6 +211,30 @@ int get_num_threads();
 /// Set the number of threads
 void set_num_threads(int num_threads);
 
+/// Get the current limit of active threads, 0 = no limit
+int get_active_threads();
+
+/// Limit the number of threads that are actively working on
+/// running (and future) computations. This can be called
+/// from another thread while a computation is running.
+/// Threads above the limit are parked once they have
+/// finished their current work unit and they resume once
+/// the limit is increased. A running computation uses at
+/// most the number of threads it was started with, hence
+/// start it using all threads in order to be able to grow
+/// it later. 0 removes the limit (default).
+///
+void set_active_threads(int threads);
+
+/// Store the results of pi(x) and nth_prime(n) in a file and
+/// reuse them in later computations, also across processes.
+/// Only results with x >= 10^10 are stored. The file is
+/// created if it does not exist. An empty filename disables
+/// the store (default).
+/// Throws a primecount_error if the file cannot be opened.
+///
+void set_pi_store(const std::string& filename);
+
 /// Get the primecount version number, in the form “i.j”
 std::string primecount_version();
 
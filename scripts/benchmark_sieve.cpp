@@ -0,0 +1,70 @@
+// Benchmark Sieve::cross_off_count() and Sieve::count() at large b.
+// The Sieve is used like in the D and S2_hard formulas: each segment
+// has the maximum segment size used by LoadBalancerS2 and all
+// sieving primes <= sqrt(high) are crossed off.
+//
+// 1. Build primecount: cmake . && make -j
+// 2. Build the benchmark:
+//    c++ -O3 -DNDEBUG -I../include -I../lib/primesieve/include \
+//        benchmark_sieve.cpp ../libprimecount.a ../libprimesieve.a -fopenmp -o benchmark_sieve
+// 3. Run: ./benchmark_sieve [low] [segments] [leaves per b]
+//    e.g. ./benchmark_sieve 100000000000000000 3 0
+
+#include <Sieve.hpp>
+#include <generate.hpp>
+#include <imath.hpp>
+#include <primecount-config.hpp>
+
+#include <stdint.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace primecount;
+
+int main(int argc, char** argv)
+{
+  uint64_t low = (argc > 1) ? std::stoull(argv[1]) : 10000000000000ull;
+  int segments = (argc > 2) ? std::stoi(argv[2]) : 3;
+  int leaves = (argc > 3) ? std::stoi(argv[3]) : 1;
+
+  low -= low % 240;
+  uint64_t segment_size = Sieve::get_segment_size(L1D_CACHE_SIZE * 2 * 30);
+  uint64_t high = low + segment_size * segments;
+  auto primes = generate_primes<uint32_t>(isqrt(high));
+  uint64_t max_b = primes.size() - 1;
+
+  Sieve sieve(low, segment_size, max_b);
+  std::mt19937_64 gen(1);
+  uint64_t sum = 0;
+  auto t1 = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < segments; i++, low += segment_size)
+  {
+    sieve.pre_sieve(primes, 3, low, low + segment_size);
+
+    for (uint64_t b = 4; b <= max_b; b++)
+    {
+      // Simulate the special leaves of the current b
+      uint64_t stop = 0;
+      for (int j = 0; j < leaves; j++)
+      {
+        stop += gen() % (segment_size / leaves);
+        sum += sieve.count(stop);
+      }
+
+      sieve.cross_off_count(primes[b], b);
+    }
+  }
+
+  auto t2 = std::chrono::steady_clock::now();
+  std::chrono::duration<double> secs = t2 - t1;
+
+  std::cout << "max_b = " << max_b << std::endl;
+  std::cout << "leaves/b = " << leaves << std::endl;
+  std::cout << "sum = " << sum << std::endl;
+  std::cout << "Seconds: " << secs.count() << std::endl;
+
+  return 0;
+}
@@ -8,16 +8,24 @@
 ///        uses the uint64_t data type, one sieve array element
 ///        (8 bytes) corresponds to an interval of size 30 * 8 = 240.
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
 ///
 
 #include <BitSieve240.hpp>
+#include <primecount-internal.hpp>
 #include <Vector.hpp>
+#include <macros.hpp>
+#include <popcnt.hpp>
 
 #include <stdint.h>
+#include <cstddef>
+
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  #include <immintrin.h>
+#endif
 
 namespace {
 
@@ -43,6 +51,68 @@ constexpr uint64_t unset_l(int n)
   return (n == 0) ? 0 : ~0ull >> right_shift(n);
 }
 
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+
+const bool cpu_supports_avx512_vpopcnt =
+    __builtin_cpu_supports("avx512f") &&
+    __builtin_cpu_supports("avx512dq") &&
+    __builtin_cpu_supports("avx512vpopcntdq");
+
+/// Look up 8 PrimePi values per loop iteration. AVX512 has no
+/// 64-bit integer division, hence x / 240 is computed using
+/// double precision floating point numbers. This is exact
+/// after correcting the quotient by +-1 if x < 2^52. The pi_t
+/// elements (count, bits) and the unset_larger bitmasks are
+/// loaded using gather instructions.
+///
+__attribute__ ((target ("avx512f,avx512dq,avx512vpopcntdq")))
+void pi_lookup_avx512(const uint64_t* pi,
+                      uint64_t low,
+                      const uint64_t* pi_tiny,
+                      const uint64_t* unset_larger,
+                      const uint64_t* xs,
+                      std::size_t n,
+                      int64_t* out)
+{
+  const __m512d inv240 = _mm512_set1_pd(1.0 / 240);
+  const __m512i c240 = _mm512_set1_epi64(240);
+  const __m512i c6 = _mm512_set1_epi64(6);
+  const __m512i one = _mm512_set1_epi64(1);
+  const __m512i vlow = _mm512_set1_epi64((int64_t) low);
+  const __m512i zero = _mm512_setzero_si512();
+
+  for (std::size_t i = 0; i < n; i += 8)
+  {
+    __mmask8 mask = (n - i >= 8) ? 0xff : (__mmask8) ((1u << (n - i)) - 1);
+    __m512i x = _mm512_maskz_loadu_epi64(mask, &xs[i]);
+    __mmask8 tiny = _mm512_mask_cmplt_epu64_mask(mask, x, c6);
+    x = _mm512_sub_epi64(x, vlow);
+
+    // q = x / 240, r = x % 240
+    __m512i q = _mm512_cvttpd_epu64(_mm512_mul_pd(_mm512_cvtepu64_pd(x), inv240));
+    __m512i r = _mm512_sub_epi64(x, _mm512_mullo_epi64(q, c240));
+    __mmask8 too_large = _mm512_cmplt_epi64_mask(r, zero);
+    q = _mm512_mask_sub_epi64(q, too_large, q, one);
+    r = _mm512_mask_add_epi64(r, too_large, r, c240);
+    __mmask8 too_small = _mm512_cmpge_epi64_mask(r, c240);
+    q = _mm512_mask_add_epi64(q, too_small, q, one);
+    r = _mm512_mask_sub_epi64(r, too_small, r, c240);
+
+    // pi[q].count, pi[q].bits
+    __m512i index = _mm512_slli_epi64(q, 1);
+    __m512i count = _mm512_mask_i64gather_epi64(zero, mask, index, (const long long*) pi, 8);
+    __m512i bits = _mm512_mask_i64gather_epi64(zero, mask, _mm512_add_epi64(index, one), (const long long*) pi, 8);
+    __m512i bitmask = _mm512_mask_i64gather_epi64(zero, mask, r, (const long long*) unset_larger, 8);
+    __m512i res = _mm512_add_epi64(count, _mm512_popcnt_epi64(_mm512_and_si512(bits, bitmask)));
+
+    // pi(x) for x < 6
+    res = _mm512_mask_i64gather_epi64(res, tiny, _mm512_add_epi64(x, vlow), (const long long*) pi_tiny, 8);
+    _mm512_mask_storeu_epi64(&out[i], mask, res);
+  }
+}
+
+#endif
+
 } // namespace
 
 namespace primecount {
@@ -209,4 +279,40 @@ const Array<uint64_t, 240> BitSieve240::unset_larger_ =
   unset_l(235), unset_l(236), unset_l(237), unset_l(238), unset_l(239)
 };
 
+void BitSieve240::pi_lookup(const pi_t* pi,
+                            uint64_t low,
+                            uint64_t size,
+                            const uint64_t* xs,
+                            std::size_t n,
+                            int64_t* out)
+{
+#if defined(ENABLE_MULTIARCH_AVX512_VPOPCNT)
+  if (cpu_supports_avx512_vpopcnt &&
+      size <= (1ull << 52))
+  {
+    pi_lookup_avx512(&pi[0].count, low, pi_tiny_.data(), unset_larger_.data(), xs, n, out);
+    return;
+  }
+#else
+  unused_param(size);
+#endif
+
+  for (std::size_t i = 0; i < n; i++)
+  {
+    uint64_t x = xs[i];
+
+    if_unlikely(x < pi_tiny_.size())
+    {
+      out[i] = pi_tiny_[x];
+      continue;
+    }
+
+    x -= low;
+    uint64_t count = pi[x / 240].count;
+    uint64_t bits = pi[x / 240].bits;
+    uint64_t bitmask = unset_larger_[x % 240];
+    out[i] = count + popcnt64(bits & bitmask);
+  }
+}
+
 } // namespace
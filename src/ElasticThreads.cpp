@@ -0,0 +1,178 @@
+///
+/// @file  ElasticThreads.cpp
+/// @brief Limit the number of threads that work on a running
+///        computation, see ElasticThreads.hpp. The thread limit
+///        is only checked when a thread requests its next work
+///        unit, hence after lowering the limit the threads finish
+///        their current work unit before they are parked.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <ElasticThreads.hpp>
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 0 = no limit
+std::atomic<int> active_threads_(0);
+// Totals of all ElasticThreads objects
+std::atomic<int> running_threads_(0);
+std::atomic<int> parked_threads_(0);
+std::atomic<uint64_t> next_id_(1);
+std::atomic<bool> is_threads_file_(false);
+std::atomic<double> next_poll_(0);
+std::string threads_file_;
+
+// The ElasticThreads objects from which this thread got its
+// current work units. This is a stack because a work unit
+// may compute pi(x) using nested load balancers.
+thread_local std::vector<uint64_t> thread_ids_;
+// Number of ElasticThreads objects in which this thread
+// is currently counted as running. With nested load
+// balancers a thread is only counted once in
+// running_threads_.
+thread_local int thread_running_ = 0;
+
+void inc_running()
+{
+  if (thread_running_++ == 0)
+    running_threads_++;
+}
+
+void dec_running()
+{
+  if (--thread_running_ == 0)
+    running_threads_--;
+}
+
+/// Read the number of active threads from the control
+/// file. Only 1 thread reads the file at most once per
+/// second, invalid file contents are ignored.
+///
+void poll_threads_file()
+{
+  if (!is_threads_file_)
+    return;
+
+  double time = primecount::get_time_coarse();
+  double next = next_poll_.load();
+
+  if (time < next ||
+      !next_poll_.compare_exchange_strong(next, time + 1.0))
+    return;
+
+  std::ifstream file(threads_file_);
+  int threads = -1;
+
+  if (file >> threads && threads >= 0)
+    active_threads_ = threads;
+}
+
+} // namespace
+
+namespace primecount {
+
+ElasticThreads::ElasticThreads()
+  : id_(next_id_++)
+{ }
+
+void ElasticThreads::wait()
+{
+  // The previous work unit of this thread has finished
+  if (!thread_ids_.empty() &&
+      thread_ids_.back() == id_)
+  {
+    running_--;
+    dec_running();
+  }
+  else
+    thread_ids_.push_back(id_);
+
+  bool is_parked = false;
+
+  while (true)
+  {
+    poll_threads_file();
+    int limit = active_threads_;
+    int running = running_;
+
+    if (limit <= 0 ||
+        running < limit ||
+        is_finished_)
+    {
+      if (running_.compare_exchange_weak(running, running + 1))
+      {
+        inc_running();
+        if (is_parked)
+          parked_threads_--;
+        return;
+      }
+    }
+    else
+    {
+      if (!is_parked)
+      {
+        is_parked = true;
+        parked_threads_++;
+      }
+
+      // Parked, the thread sleeps until the limit is
+      // increased or until all work has been handed out.
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+}
+
+void ElasticThreads::finish()
+{
+  running_--;
+  dec_running();
+  is_finished_ = true;
+
+  if (!thread_ids_.empty() &&
+      thread_ids_.back() == id_)
+    thread_ids_.pop_back();
+}
+
+void set_threads_file(const std::string& filename)
+{
+  threads_file_ = filename;
+  next_poll_ = 0;
+  is_threads_file_ = !filename.empty();
+}
+
+void set_active_threads(int threads)
+{
+  active_threads_ = std::max(threads, 0);
+}
+
+int get_active_threads()
+{
+  return active_threads_;
+}
+
+int get_running_threads()
+{
+  return running_threads_;
+}
+
+int get_parked_threads()
+{
+  return parked_threads_;
+}
+
+} // namespace
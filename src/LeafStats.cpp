@@ -0,0 +1,197 @@
+///
+/// @file  LeafStats.cpp
+/// @brief Thread-local special leaf counters, see LeafStats.hpp.
+///        Each thread registers its counters in a global list the
+///        first time it uses them. When a thread exits its counters
+///        are merged into the global counters of the exited threads.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <LeafStats.hpp>
+#include <primecount.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace primecount;
+
+const char* formula_names[LEAF_FORMULAS] =
+{
+  "A", "C", "D", "S2_easy", "S2_hard"
+};
+
+std::mutex mutex_;
+std::vector<LeafStats*> threads_stats_;
+LeafStats exited_threads_stats_;
+
+struct ThreadLeafStats
+{
+  LeafStats stats;
+
+  ThreadLeafStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_stats_.push_back(&stats);
+  }
+
+  ~ThreadLeafStats()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exited_threads_stats_ += stats;
+    auto iter = std::find(threads_stats_.begin(), threads_stats_.end(), &stats);
+    if (iter != threads_stats_.end())
+      threads_stats_.erase(iter);
+  }
+};
+
+bool ends_with(const std::string& str,
+               const std::string& suffix)
+{
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void write_csv(std::ofstream& file, const LeafStats& stats)
+{
+  file << "formula,bucket,bucket_min,b_leaves,low_leaves\n";
+
+  for (int f = 0; f < LEAF_FORMULAS; f++)
+    for (int i = 0; i < LeafStats::BUCKETS; i++)
+      if (stats.b_leaves[f][i] || stats.low_leaves[f][i])
+        file << formula_names[f] << ","
+             << i << ","
+             << (i ? (uint64_t) 1 << i : 0) << ","
+             << stats.b_leaves[f][i] << ","
+             << stats.low_leaves[f][i] << "\n";
+
+  file << "\nformula,clustered_leaves,sparse_leaves\n";
+
+  for (int f = 0; f < LEAF_FORMULAS; f++)
+    file << formula_names[f] << ","
+         << stats.clustered_leaves[f] << ","
+         << stats.sparse_leaves[f] << "\n";
+
+  file << "\nsieve_count_calls,sieve_count_words\n";
+  file << stats.sieve_count_calls << ","
+       << stats.sieve_count_words << "\n";
+}
+
+void write_json_array(std::ofstream& file, const uint64_t* array, int size)
+{
+  file << "[";
+  for (int i = 0; i < size; i++)
+    file << (i ? ", " : "") << array[i];
+  file << "]";
+}
+
+void write_json(std::ofstream& file, const LeafStats& stats)
+{
+  file << "{\n";
+  file << "  \"sieve_count_calls\": " << stats.sieve_count_calls << ",\n";
+  file << "  \"sieve_count_words\": " << stats.sieve_count_words << ",\n";
+  file << "  \"formulas\": {\n";
+
+  for (int f = 0; f < LEAF_FORMULAS; f++)
+  {
+    file << "    \"" << formula_names[f] << "\": {\n";
+    file << "      \"clustered_leaves\": " << stats.clustered_leaves[f] << ",\n";
+    file << "      \"sparse_leaves\": " << stats.sparse_leaves[f] << ",\n";
+    file << "      \"b_leaves\": ";
+    write_json_array(file, stats.b_leaves[f], LeafStats::BUCKETS);
+    file << ",\n      \"low_leaves\": ";
+    write_json_array(file, stats.low_leaves[f], LeafStats::BUCKETS);
+    file << "\n    }" << (f + 1 < LEAF_FORMULAS ? "," : "") << "\n";
+  }
+
+  file << "  }\n";
+  file << "}\n";
+}
+
+} // namespace
+
+namespace primecount {
+
+LeafStats::LeafStats()
+{
+  std::fill_n(&b_leaves[0][0], LEAF_FORMULAS * BUCKETS, 0);
+  std::fill_n(&low_leaves[0][0], LEAF_FORMULAS * BUCKETS, 0);
+  std::fill_n(clustered_leaves, LEAF_FORMULAS, 0);
+  std::fill_n(sparse_leaves, LEAF_FORMULAS, 0);
+  sieve_count_calls = 0;
+  sieve_count_words = 0;
+  low = 0;
+}
+
+LeafStats& LeafStats::operator+=(const LeafStats& other)
+{
+  for (int f = 0; f < LEAF_FORMULAS; f++)
+  {
+    for (int i = 0; i < BUCKETS; i++)
+    {
+      b_leaves[f][i] += other.b_leaves[f][i];
+      low_leaves[f][i] += other.low_leaves[f][i];
+    }
+
+    clustered_leaves[f] += other.clustered_leaves[f];
+    sparse_leaves[f] += other.sparse_leaves[f];
+  }
+
+  sieve_count_calls += other.sieve_count_calls;
+  sieve_count_words += other.sieve_count_words;
+
+  return *this;
+}
+
+LeafStats& thread_leaf_stats()
+{
+  thread_local ThreadLeafStats thread_stats;
+  return thread_stats.stats;
+}
+
+/// Must not be called while a computation is running
+LeafStats get_leaf_stats()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  LeafStats stats = exited_threads_stats_;
+
+  for (const LeafStats* thread_stats : threads_stats_)
+    stats += *thread_stats;
+
+  return stats;
+}
+
+void reset_leaf_stats()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  exited_threads_stats_ = LeafStats();
+
+  for (LeafStats* thread_stats : threads_stats_)
+    *thread_stats = LeafStats();
+}
+
+void write_leaf_stats(const std::string& filename)
+{
+  std::ofstream file(filename);
+
+  if (!file)
+    throw primecount_error("failed to open file: " + filename);
+
+  LeafStats stats = get_leaf_stats();
+
+  if (ends_with(filename, ".json"))
+    write_json(file, stats);
+  else
+    write_csv(file, stats);
+}
+
+} // namespace
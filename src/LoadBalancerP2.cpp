@@ -11,12 +11,15 @@
 ///
 
 #include <LoadBalancerP2.hpp>
+#include <ElasticThreads.hpp>
+#include <StatusThread.hpp>
 #include <primecount-internal.hpp>
 #include <imath.hpp>
 #include <min.hpp>
 
 #include <stdint.h>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <iostream>
 #include <iomanip>
@@ -44,12 +47,23 @@ LoadBalancerP2::LoadBalancerP2(maxint_t x,
   threads = std::min(threads, max_threads);
   threads_ = ideal_num_threads(dist, threads, min_thread_dist_);
   lock_.init(threads_);
+  thread_groups_.init(threads_);
+  groups_.reset(new ThreadGroup[thread_groups_.size()]);
+
+  for (int i = 0; i < thread_groups_.size(); i++)
+    groups_[i].lock.init(threads_);
 
   // Using more chunks per thread improves load
   // balancing but also adds some overhead.
   int64_t chunks_per_thread = 8;
   thread_dist_ = dist / (threads_ * chunks_per_thread);
   thread_dist_ = max(min_thread_dist_, thread_dist_);
+
+  if (is_print_)
+  {
+    publish_status();
+    status_thread_.start([this] { print_status(); });
+  }
 }
 
 int LoadBalancerP2::get_threads() const
@@ -60,8 +74,42 @@ int LoadBalancerP2::get_threads() const
 /// The thread needs to sieve [low, high[
 bool LoadBalancerP2::get_work(int64_t& low, int64_t& high)
 {
-  LockGuard lockGuard(lock_);
-  print_status();
+  // Park this thread if too many threads are active
+  elastic_.wait();
+  int g = thread_groups_.get_group();
+  ThreadGroup& group = groups_[g];
+
+  {
+    LockGuard groupGuard(group.lock);
+    if (group.chunk.pop_front(low, high))
+      return true;
+  }
+
+  {
+    LockGuard lockGuard(lock_);
+    LockGuard groupGuard(group.lock);
+
+    // Another thread of this group may
+    // have fetched a new chunk meanwhile.
+    if (group.chunk.pop_front(low, high) ||
+        (get_chunk(g) && group.chunk.pop_front(low, high)))
+      return true;
+  }
+
+  if (steal_unit(groups_.get(), thread_groups_.size(), g, low, high))
+    return true;
+
+  elastic_.finish();
+  return false;
+}
+
+/// Hand out the next chunk of work to the thread group,
+/// must be called inside the global critical section.
+/// Without thread groups each chunk is a single work unit.
+///
+bool LoadBalancerP2::get_chunk(int g)
+{
+  publish_status();
 
   // Calculate the remaining sieving distance
   low_ = min(low_, sieve_limit_);
@@ -96,31 +144,43 @@ bool LoadBalancerP2::get_work(int64_t& low, int64_t& high)
       thread_dist_ = max(min_thread_dist_, max_thread_dist);
   }
 
-  low = low_;
-  low_ += thread_dist_;
-  low_ = min(low_, sieve_limit_);
-  high = low_;
+  int64_t chunk_dist = thread_dist_;
+  int groups = thread_groups_.size();
+
+  // Each chunk contains one work unit per thread of the
+  // group, but at most the group's share of the
+  // remaining sieving distance.
+  if (groups > 1)
+  {
+    chunk_dist *= thread_groups_.threads(g);
+    chunk_dist = min(chunk_dist, dist / groups);
+    chunk_dist = max(chunk_dist, thread_dist_);
+  }
 
-  return low < sieve_limit_;
+  GroupChunk& chunk = groups_[g].chunk;
+  chunk.assign(low_, min(low_ + chunk_dist, sieve_limit_), thread_dist_);
+  low_ = chunk.high;
+
+  return !chunk.empty();
 }
 
-void LoadBalancerP2::print_status()
+/// Called by the worker threads inside the critical section,
+/// the status is printed by the status thread.
+///
+void LoadBalancerP2::publish_status()
 {
   if (is_print_)
-  {
-    double time = get_time();
-    double old = time_;
-    double threshold = 0.1;
-
-    if ((time - old) >= threshold)
-    {
-      time_ = time;
-      double percent = get_percent(low_, sieve_limit_);
-      std::ostringstream status;
-      status << "\rStatus: " << std::fixed << std::setprecision(precision_) << percent << '%';
-      std::cout << status.str() << std::flush;
-    }
-  }
+    status_low_.store(low_, std::memory_order_relaxed);
+}
+
+/// Called by the status thread every 0.1 seconds
+void LoadBalancerP2::print_status()
+{
+  int64_t low = status_low_.load(std::memory_order_relaxed);
+  double percent = get_percent(low, sieve_limit_);
+  std::ostringstream status;
+  status << "\rStatus: " << std::fixed << std::setprecision(precision_) << percent << '%';
+  std::cout << status.str() << std::flush;
 }
 
 } // namespace
@@ -22,25 +22,79 @@
 ///        order to prevent that 1 thread will run much longer
 ///        than all the other threads.
 ///
-/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+///        For benchmarking the work units can be recorded and
+///        replayed or a static partition can be used instead,
+///        see WorkLog.hpp.
+///
+///        Once all work units have been handed out, idle threads
+///        run backup copies of the oldest unfinished work units.
+///        The first copy to finish wins and the other copy is
+///        cancelled. On shared or heterogeneous nodes a single
+///        slowed down thread would otherwise delay the end of the
+///        computation. Work units are deterministic, if both
+///        copies complete their results must be identical.
+///
+///        On machines with many CPU cores the threads are
+///        partitioned into thread groups (see ThreadGroups.hpp).
+///        Each group fetches a chunk of work units from the global
+///        sieve interval and its threads take the work units from
+///        that chunk using the group's own lock. The finished
+///        work units are buffered by the group and added one by
+///        one to the progress model and the load balancing once
+///        a thread of the group acquires the global lock. Without
+///        thread groups (e.g. on machines with fewer CPU cores)
+///        each chunk is a single work unit.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
 ///
 
 #include <LoadBalancerS2.hpp>
+#include <ElasticThreads.hpp>
+#include <primecount.hpp>
 #include <primecount-config.hpp>
 #include <primecount-internal.hpp>
 #include <StatusS2.hpp>
 #include <Sieve.hpp>
+#include <WorkLog.hpp>
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <min.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+// A work unit is backed up once it has been running
+// for backup_secs_ seconds and more than twice the
+// average work unit runtime.
+std::atomic<double> backup_secs_(0.1);
+std::atomic<int64_t> backup_units_(0);
+
+} // namespace
 
 namespace primecount {
 
+/// Used for testing, backup_secs = 0 backs up every
+/// unfinished work unit once all work units have been
+/// handed out.
+///
+void set_backup_threshold(double backup_secs)
+{
+  backup_secs_ = backup_secs;
+}
+
+int64_t get_backup_units()
+{
+  return backup_units_;
+}
+
 LoadBalancerS2::LoadBalancerS2(maxint_t x,
                                int64_t sieve_limit,
                                maxint_t sum_approx,
@@ -50,9 +104,31 @@ LoadBalancerS2::LoadBalancerS2(maxint_t x,
   sum_approx_(sum_approx),
   time_(get_time()),
   is_print_(is_print),
-  status_(x)
+  status_(x, is_print),
+  log_("LoadBalancerS2", sieve_limit)
 {
   lock_.init(threads);
+  status_.set_threads(threads);
+
+  // The recorded work units must be
+  // handed out in the same order.
+  bool is_groups = !log_.is_record() && !log_.is_replay();
+  thread_groups_.init(threads, is_groups);
+  groups_.reset(new Group[thread_groups_.size()]);
+
+  for (int i = 0; i < thread_groups_.size(); i++)
+  {
+    Group& group = groups_[i];
+    group.lock.init(threads);
+    int group_threads = thread_groups_.threads(i);
+
+    // Backup work units require at least 2 threads
+    if (group_threads > 1)
+    {
+      group.max_slots = group_threads;
+      group.slots.reset(new Slot[group_threads]);
+    }
+  }
 
   // The best performance is usually achieved using
   // a sieve array size that matches your CPU's L1
@@ -85,6 +161,21 @@ LoadBalancerS2::LoadBalancerS2(maxint_t x,
     segments_ = 1;
   }
 
+  // Deterministic partition that only depends
+  // on x and the number of threads.
+  if (get_load_balancing() == LOAD_BALANCING_STATIC)
+  {
+    is_adaptive_ = false;
+    segment_size_ = max_size_;
+    int64_t units = (int64_t) threads * 16;
+    segments_ = ceil_div(sieve_limit, segment_size_ * units);
+    segments_ = max(segments_, 1);
+  }
+
+  // Replayed work units are not modified
+  if (log_.is_replay())
+    is_adaptive_ = false;
+
   int64_t min_size = 1 << 9;
   segment_size_ = max(min_size, segment_size_);
   segment_size_ = Sieve::get_segment_size(segment_size_);
@@ -92,34 +183,317 @@ LoadBalancerS2::LoadBalancerS2(maxint_t x,
 
 maxint_t LoadBalancerS2::get_sum() const
 {
-  return sum_;
+  maxint_t sum = sum_;
+
+  for (int i = 0; i < thread_groups_.size(); i++)
+  {
+    // A work unit and its backup copy computed different
+    // results, this indicates a bug or a hardware error.
+    if (groups_[i].is_mismatch)
+      throw primecount_error("LoadBalancerS2: backup work unit result mismatch");
+
+    sum += groups_[i].sum;
+  }
+
+  return sum;
 }
 
+/// Add the result of the thread's previous work unit and
+/// assign it a new work unit. Once all work units have
+/// been handed out the thread may run a backup copy of a
+/// straggler work unit. Returns false if there is no
+/// more work.
+///
 bool LoadBalancerS2::get_work(ThreadData& thread)
 {
-  LockGuard lockGuard(lock_);
-  sum_ += thread.sum;
+  // Park this thread if too many threads are active
+  elastic_.wait();
+  int g = thread_groups_.get_group();
+  Group& group = groups_[g];
 
-  if (is_print_)
   {
-    uint64_t dist = thread.segments * thread.segment_size;
-    uint64_t high = thread.low + dist;
+    LockGuard groupGuard(group.lock);
+    // Only the first copy of a backed up work
+    // unit is added to the progress model.
+    if (!finish_unit(group, thread) &&
+        thread.segments > 0)
+      group.finished.push_back(thread);
+
+    if (get_group_unit(group, thread))
+      return true;
+  }
+
+  {
+    LockGuard lockGuard(lock_);
+    LockGuard groupGuard(group.lock);
+    sum_ += group.sum;
+    group.sum = 0;
+    update_status(group);
+
+    // Another thread of this group may
+    // have fetched a new chunk meanwhile.
+    if (get_group_unit(group, thread) ||
+        (get_chunk(g) && get_group_unit(group, thread)))
+      return true;
+
+    thread.sum = 0;
+  }
+
+  if (steal_unit(g, thread))
+    return true;
+
+  // All work units have been handed out
+  elastic_.finish();
+  return get_backup_unit(group, thread);
+}
+
+/// Calibrate the progress model and the load balancing
+/// using the finished work units of the thread group.
+/// Must be called inside the global critical section.
+///
+void LoadBalancerS2::update_status(Group& group)
+{
+  if (group.finished.empty())
+    return;
+
+  // The load balancing is only updated by work
+  // units whose low is larger than max_low_.
+  std::sort(group.finished.begin(), group.finished.end(),
+    [](const ThreadData& a, const ThreadData& b) { return a.low < b.low; });
+
+  int64_t high = 0;
+
+  for (const ThreadData& thread : group.finished)
+  {
+    int64_t thread_dist = thread.segments * thread.segment_size;
+    thread_dist = min(thread_dist, sieve_limit_ - thread.low);
+    status_.add_work(thread.low, thread_dist, sieve_limit_, thread.secs);
+    high = max(high, thread.low + thread_dist);
+
+    if (is_adaptive_)
+      update_load_balancing(thread);
+  }
+
+  group.finished.clear();
+
+  if (is_print_)
     status_.print(high, sieve_limit_, sum_, sum_approx_);
+}
+
+/// Hand out the next chunk of work units to the thread
+/// group. Must be called inside the global critical
+/// section. Returns false if all work units have
+/// been handed out.
+///
+bool LoadBalancerS2::get_chunk(int g)
+{
+  WorkUnit unit = { low_, segments_, segment_size_ };
+
+  // Hand out the recorded work units in the same order,
+  // afterwards there is no more work.
+  if (log_.is_replay() &&
+      !log_.replay(unit))
+    unit = { sieve_limit_, 0, 0 };
+
+  if (unit.low >= sieve_limit_)
+    return false;
+
+  int64_t unit_dist = unit.segments * unit.segment_size;
+  int64_t units = 1;
+  int groups = thread_groups_.size();
+
+  // Each chunk contains one work unit per thread of the
+  // group, but at most the group's share of the
+  // remaining work units.
+  if (groups > 1)
+  {
+    int64_t remaining = ceil_div(sieve_limit_ - unit.low, unit_dist);
+    units = min(remaining / groups, thread_groups_.threads(g));
+    units = max(units, 1);
+  }
+
+  Group& group = groups_[g];
+  group.chunk.assign(unit.low, unit.low + units * unit_dist, unit_dist);
+  group.segment_size = unit.segment_size;
+  low_ = group.chunk.high;
+
+  if (log_.is_record())
+    log_.record(unit);
+
+  return true;
+}
+
+/// Assign the thread the next work unit of its group's
+/// chunk, must be called inside the group's critical
+/// section.
+///
+bool LoadBalancerS2::get_group_unit(Group& group, ThreadData& thread)
+{
+  int64_t low, high;
+
+  if (!group.chunk.pop_front(low, high))
+    return false;
+
+  int64_t segments = ceil_div(high - low, group.segment_size);
+  start_unit(group, thread, { low, segments, group.segment_size });
+  return true;
+}
+
+/// Once all chunks have been handed out, steal the last
+/// work unit of another thread group's chunk.
+///
+bool LoadBalancerS2::steal_unit(int g, ThreadData& thread)
+{
+  int groups = thread_groups_.size();
+
+  for (int i = 1; i < groups; i++)
+  {
+    Group& victim = groups_[(g + i) % groups];
+    int64_t low, high, segment_size;
+
+    {
+      LockGuard victimGuard(victim.lock);
+      if (!victim.chunk.pop_back(low, high))
+        continue;
+      segment_size = victim.segment_size;
+    }
+
+    Group& group = groups_[g];
+    LockGuard groupGuard(group.lock);
+    int64_t segments = ceil_div(high - low, segment_size);
+    start_unit(group, thread, { low, segments, segment_size });
+    return true;
+  }
+
+  return false;
+}
+
+/// Add the result of the thread's previous work unit.
+/// Returns true if the other copy of this work unit has
+/// already finished, then the result is discarded.
+/// Must be called inside the group's critical section.
+///
+bool LoadBalancerS2::finish_unit(Group& group, ThreadData& thread)
+{
+  if (thread.slot < 0 ||
+      !group.slots[thread.slot].is_busy)
+  {
+    group.sum += thread.sum;
+    return false;
+  }
+
+  Slot& slot = group.slots[thread.slot];
+  slot.is_busy = false;
+
+  if (slot.peer < 0)
+  {
+    group.sum += thread.sum;
+    group.avg_secs = group.avg_secs * 0.9 + thread.secs * 0.1;
+    return false;
+  }
+
+  if (!slot.has_result)
+  {
+    // This is the first copy to finish,
+    // cancel the other copy.
+    Slot& peer = group.slots[slot.peer];
+    peer.result = thread.sum;
+    peer.has_result = true;
+    peer.cancel = true;
+    slot.peer = -1;
+    group.sum += thread.sum;
+    return false;
   }
 
-  update_load_balancing(thread);
+  // If the other copy has not been cancelled
+  // both results must be identical.
+  if (!thread.cancelled &&
+      thread.sum != slot.result)
+    group.is_mismatch = true;
 
-  thread.low = low_;
-  thread.segments = segments_;
-  thread.segment_size = segment_size_;
+  slot.peer = -1;
+  slot.has_result = false;
+  return true;
+}
+
+void LoadBalancerS2::start_unit(Group& group,
+                                ThreadData& thread,
+                                const WorkUnit& unit)
+{
+  thread.low = unit.low;
+  thread.segments = unit.segments;
+  thread.segment_size = unit.segment_size;
   thread.sum = 0;
   thread.secs = 0;
   thread.init_secs = 0;
+  thread.cancelled = false;
 
-  low_ += segments_ * segment_size_;
-  bool is_work = thread.low < sieve_limit_;
+  if (thread.slot < 0 &&
+      group.used_slots < group.max_slots)
+    thread.slot = group.used_slots++;
 
-  return is_work;
+  if (thread.slot >= 0)
+  {
+    Slot& slot = group.slots[thread.slot];
+    slot.unit = unit;
+    slot.start = get_time_coarse();
+    slot.is_busy = true;
+    slot.cancel = false;
+    thread.cancel = &slot.cancel;
+  }
+}
+
+/// Once all work units have been handed out, idle threads
+/// run a backup copy of the oldest unfinished work unit
+/// (of their thread group) that has been running much
+/// longer than the average work unit. Returns false if
+/// there is no such work unit left.
+///
+bool LoadBalancerS2::get_backup_unit(Group& group, ThreadData& thread)
+{
+  if (thread.slot < 0)
+    return false;
+
+  while (true)
+  {
+    {
+      LockGuard groupGuard(group.lock);
+      double time = get_time_coarse();
+      double min_secs = backup_secs_;
+      if (min_secs > 0)
+        min_secs = max(min_secs, group.avg_secs * 2);
+      bool is_candidate = false;
+      int oldest = -1;
+
+      for (int i = 0; i < group.used_slots; i++)
+      {
+        const Slot& slot = group.slots[i];
+
+        // Each work unit is backed up at most once
+        if (slot.is_busy && slot.peer < 0)
+        {
+          is_candidate = true;
+          if (time - slot.start >= min_secs &&
+              (oldest < 0 || slot.start < group.slots[oldest].start))
+            oldest = i;
+        }
+      }
+
+      if (oldest >= 0)
+      {
+        start_unit(group, thread, group.slots[oldest].unit);
+        group.slots[thread.slot].peer = oldest;
+        group.slots[oldest].peer = thread.slot;
+        backup_units_++;
+        return true;
+      }
+
+      if (!is_candidate)
+        return false;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
 }
 
 void LoadBalancerS2::update_load_balancing(const ThreadData& thread)
@@ -13,6 +13,7 @@
 #include <generate.hpp>
 #include <imath.hpp>
 #include <macros.hpp>
+#include <parallel.hpp>
 #include <PiTable.hpp>
 #include <print.hpp>
 
@@ -47,7 +48,7 @@ int64_t P3(int64_t x,
   {
     int64_t max_prime = std::max(x13, isqrt(x / y));
     int64_t max_pix = std::max(x13, x / (y * y));
-    auto primes = generate_primes<int32_t>(max_prime);
+    auto primes = generate_primes<int32_t>(max_prime, threads);
     PiTable pi(max_pix, threads);
     int64_t pi_x13 = pi[x13];
 
@@ -56,15 +57,17 @@ int64_t P3(int64_t x,
     int64_t thread_threshold = 100;
     threads = ideal_num_threads(pi_x13, threads, thread_threshold);
 
-    #pragma omp parallel for schedule(dynamic, 16) num_threads(threads) reduction(+: sum)
-    for (int64_t i = a + 1; i <= pi_x13; i++)
+    sum = parallel_for_sum<int64_t>(threads, a + 1, pi_x13 + 1, 16, [&](int64_t i)
     {
       int64_t xi = x / primes[i];
       int64_t bi = pi[isqrt(xi)];
+      int64_t sum_i = 0;
 
       for (int64_t j = i; j <= bi; j++)
-        sum += pi[xi / primes[j]] - (j - 1);
-    }
+        sum_i += pi[xi / primes[j]] - (j - 1);
+
+      return sum_i;
+    });
   }
 
   if (is_print)
@@ -0,0 +1,293 @@
+///
+/// @file  PiStore.cpp
+/// @brief File-backed store of pi(x) results, see PiStore.hpp.
+///        Store file format (one record per line):
+///
+///        # Comment
+///        <x> <pi(x)> <algorithm> [<parameters>]
+///        ...
+///
+///        The file is read incrementally: each lookup first reads
+///        the records that have been appended by other processes
+///        since the last lookup. Records are appended using a
+///        single write while holding an exclusive file lock. If a
+///        process crashed while appending a record the file may
+///        end with an incomplete line, this line is removed by the
+///        next process that appends a record.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <PiStore.hpp>
+#include <primecount.hpp>
+#include <int128_t.hpp>
+#include <macros.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#if __has_include(<sys/file.h>) && \
+    __has_include(<unistd.h>)
+  #include <sys/file.h>
+  #include <sys/types.h>
+  #include <unistd.h>
+  #define HAVE_FLOCK
+#endif
+
+namespace {
+
+using namespace primecount;
+
+/// pi(x) with x < 10^10 is computed in a few milliseconds,
+/// storing these results would only bloat the store.
+constexpr int64_t min_x = 10000000000ll;
+
+/// Locks the store file, the lock is shared between all
+/// threads and processes that have opened the file.
+/// Without flock() only the threads of the current
+/// process are synchronized.
+///
+class FileLock
+{
+public:
+  FileLock(FILE* file, bool exclusive)
+    : file_(file)
+  {
+#if defined(HAVE_FLOCK)
+    flock(fileno(file_), exclusive ? LOCK_EX : LOCK_SH);
+#else
+    unused_param(exclusive);
+#endif
+  }
+  ~FileLock()
+  {
+#if defined(HAVE_FLOCK)
+    flock(fileno(file_), LOCK_UN);
+#endif
+  }
+private:
+  FILE* file_;
+};
+
+std::mutex mutex_;
+std::string filename_;
+FILE* file_ = nullptr;
+// Position after the last complete record
+std::fpos_t pos_;
+// The file ends with an incomplete line
+bool is_partial_ = false;
+std::map<maxint_t, maxint_t> pi_;
+std::map<int64_t, int64_t> nth_prime_;
+
+bool parse_int(const std::string& str, maxint_t& n)
+{
+  if (str.empty() || str.size() > 40)
+    return false;
+
+  n = 0;
+  for (char c : str)
+  {
+    if (c < '0' || c > '9')
+      return false;
+    n = n * 10 + (c - '0');
+  }
+
+  return true;
+}
+
+/// Lines that cannot be parsed are ignored
+void parse_line(const std::string& line)
+{
+  if (line.empty() || line[0] == '#')
+    return;
+
+  std::istringstream iss(line);
+  std::string x_str, pix_str, algorithm;
+  maxint_t x, pix;
+
+  if (!(iss >> x_str >> pix_str >> algorithm) ||
+      !parse_int(x_str, x) ||
+      !parse_int(pix_str, pix))
+    return;
+
+  // The first record of x wins
+  pi_.emplace(x, pix);
+
+  // x is the nth prime with n = pix
+  if (algorithm == "nth_prime" &&
+      x <= std::numeric_limits<int64_t>::max())
+    nth_prime_.emplace((int64_t) pix, (int64_t) x);
+}
+
+/// Read the records that have been appended (possibly
+/// by other processes) since the last call. Must be
+/// called while holding the file lock.
+///
+void read_records()
+{
+  std::fsetpos(file_, &pos_);
+  std::string line;
+  char buffer[256];
+  is_partial_ = false;
+
+  while (std::fgets(buffer, sizeof(buffer), file_))
+  {
+    line += buffer;
+
+    if (line.back() == '\n')
+    {
+      line.pop_back();
+      parse_line(line);
+      line.clear();
+      std::fgetpos(file_, &pos_);
+    }
+  }
+
+  is_partial_ = !line.empty();
+  std::clearerr(file_);
+}
+
+/// Remove an incomplete record at the end of the file,
+/// it has been written by a process that crashed.
+/// Must be called while holding the exclusive file lock.
+///
+void remove_partial_record()
+{
+  if (!is_partial_)
+    return;
+
+#if defined(HAVE_FLOCK)
+  std::fsetpos(file_, &pos_);
+  off_t size = ftello(file_);
+  std::fflush(file_);
+  if (size >= 0 &&
+      ftruncate(fileno(file_), size) == 0)
+    is_partial_ = false;
+#endif
+}
+
+} // namespace
+
+namespace primecount {
+
+/// Use filename as pi(x) store, the file is created if it
+/// does not exist. An empty filename disables the store.
+///
+void set_pi_store(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (file_)
+    std::fclose(file_);
+
+  file_ = nullptr;
+  filename_.clear();
+  pi_.clear();
+  nth_prime_.clear();
+  is_partial_ = false;
+
+  if (filename.empty())
+    return;
+
+  // Mode "a+" creates the file if it does not exist
+  // and all writes are appended to the end of the file.
+  file_ = std::fopen(filename.c_str(), "a+");
+  if (!file_)
+    throw primecount_error("failed to open file: " + filename);
+
+  filename_ = filename;
+  std::rewind(file_);
+  std::fgetpos(file_, &pos_);
+
+  FileLock fileLock(file_, false);
+  read_records();
+}
+
+bool is_pi_store()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return file_ != nullptr;
+}
+
+bool pi_store_lookup(maxint_t x, maxint_t& pix)
+{
+  if (x < min_x)
+    return false;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_)
+    return false;
+
+  FileLock fileLock(file_, false);
+  read_records();
+
+  auto iter = pi_.find(x);
+  if (iter == pi_.end())
+    return false;
+
+  pix = iter->second;
+  return true;
+}
+
+bool nth_prime_store_lookup(int64_t n, int64_t& prime)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_)
+    return false;
+
+  FileLock fileLock(file_, false);
+  read_records();
+
+  auto iter = nth_prime_.find(n);
+  if (iter == nth_prime_.end())
+    return false;
+
+  prime = iter->second;
+  return true;
+}
+
+void pi_store_insert(maxint_t x, maxint_t pix, const std::string& algorithm)
+{
+  if (x < min_x)
+    return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!file_)
+    return;
+
+  FileLock fileLock(file_, true);
+  read_records();
+
+  // Another thread or process has already
+  // stored this result.
+  bool is_nth_prime = (algorithm == "nth_prime");
+  if (is_nth_prime ? nth_prime_.count((int64_t) pix) : pi_.count(x))
+    return;
+
+  remove_partial_record();
+
+  std::ostringstream record;
+  if (is_partial_)
+    record << '\n';
+  record << x << ' ' << pix << ' ' << algorithm << '\n';
+  std::string str = record.str();
+
+  // Write the record using a single write
+  std::fseek(file_, 0, SEEK_END);
+  if (std::fwrite(str.data(), 1, str.size(), file_) != str.size() ||
+      std::fflush(file_) != 0)
+    throw primecount_error("failed to write file: " + filename_);
+
+  // Read back our own record
+  read_records();
+}
+
+} // namespace
@@ -21,6 +21,7 @@
 #include <imath.hpp>
 #include <macros.hpp>
 #include <min.hpp>
+#include <parallel.hpp>
 
 #include <stdint.h>
 #include <algorithm>
@@ -133,30 +134,27 @@ void PiTable::init(uint64_t limit,
   thread_dist += 240 - thread_dist % 240;
   counts_.resize(threads);
 
-  #pragma omp parallel num_threads(threads)
+  parallel_for(threads, 0, threads, 1, [&](int64_t t)
   {
-    #pragma omp for
-    for (int t = 0; t < threads; t++)
-    {
-      uint64_t low = cache_limit + thread_dist * t;
-      uint64_t high = low + thread_dist;
-      high = min(high, limit);
-
-      if (low < high)
-        init_bits(low, high, t);
-    }
-
-    #pragma omp for
-    for (int t = 0; t < threads; t++)
-    {
-      uint64_t low = cache_limit + thread_dist * t;
-      uint64_t high = low + thread_dist;
-      high = min(high, limit);
-
-      if (low < high)
-        init_count(low, high, t);
-    }
-  }
+    uint64_t low = cache_limit + thread_dist * t;
+    uint64_t high = low + thread_dist;
+    high = min(high, limit);
+
+    if (low < high)
+      init_bits(low, high, t);
+  });
+
+  // init_count() requires that init_bits()
+  // has finished for all threads.
+  parallel_for(threads, 0, threads, 1, [&](int64_t t)
+  {
+    uint64_t low = cache_limit + thread_dist * t;
+    uint64_t high = low + thread_dist;
+    high = min(high, limit);
+
+    if (low < high)
+      init_count(low, high, t);
+  });
 }
 
 /// Each thread computes PrimePi [low, high[
@@ -19,6 +19,7 @@
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <Vector.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
 #include <S.hpp>
 
@@ -72,16 +73,16 @@ X S1_OpenMP(X x,
   int64_t thread_threshold = (int64_t) 1e6;
   threads = ideal_num_threads(y, threads, thread_threshold);
 
-  auto primes = generate_primes<Y>(y);
+  auto primes = generate_primes<Y>(y, threads);
   int64_t pi_y = primes.size() - 1;
   X s1 = phi_tiny(x, c);
 
-  #pragma omp parallel for schedule(static, 1) num_threads(threads) reduction (+: s1)
-  for (int64_t b = c + 1; b <= pi_y; b++)
+  s1 += parallel_for_sum<X>(threads, c + 1, pi_y + 1, 1, [&](int64_t b)
   {
-    s1 -= phi_tiny(x / primes[b], c);
-    s1 += S1_thread<1>(x, y, b, c, (X) primes[b], primes);
-  }
+    X sum = S1_thread<1>(x, y, b, c, (X) primes[b], primes);
+    sum -= phi_tiny(x / primes[b], c);
+    return sum;
+  });
 
   return s1;
 }
@@ -28,7 +28,7 @@
 ///        In-depth description of this algorithm:
 ///        https://github.com/kimwalisch/primecount/blob/master/doc/Hard-Special-Leaves.md
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -37,9 +37,11 @@
 #include <Sieve.hpp>
 #include <SieveTables.hpp>
 #include <imath.hpp>
+#include <LeafStats.hpp>
 #include <macros.hpp>
 #include <min.hpp>
 #include <Vector.hpp>
+#include <WarmCache.hpp>
 #include <popcnt.hpp>
 
 #include <stdint.h>
@@ -82,6 +84,31 @@ const Array<WheelInit, 30> wheel_init
   {4,  7}, {3,  7}, {2,  7}, {1,  7}, {0,  7}
 }};
 
+/// Used by the dense cross off algorithm to iterate over
+/// the multiples of a sieving prime without the switch
+/// statement. For each wheel index: the bit of the
+/// current multiple and the distance to the next multiple
+/// (in bytes) = (prime / 30) * factor + correct.
+///
+struct WheelStep
+{
+  uint8_t bit;
+  uint8_t factor;
+  uint8_t correct;
+};
+
+const Array<WheelStep, 64> wheel_steps
+{{
+  {0, 6, 0}, {1, 4, 0}, {2, 2, 0}, {3, 4, 0}, {4, 2, 0}, {5, 4, 0}, {6, 6, 0}, {7, 2, 1},
+  {1, 6, 1}, {5, 4, 1}, {4, 2, 1}, {0, 4, 0}, {7, 2, 1}, {3, 4, 1}, {2, 6, 1}, {6, 2, 1},
+  {2, 6, 2}, {4, 4, 2}, {0, 2, 0}, {6, 4, 2}, {1, 2, 0}, {7, 4, 2}, {3, 6, 2}, {5, 2, 1},
+  {3, 6, 3}, {0, 4, 1}, {6, 2, 1}, {5, 4, 2}, {2, 2, 1}, {1, 4, 1}, {7, 6, 3}, {4, 2, 1},
+  {4, 6, 3}, {7, 4, 3}, {1, 2, 1}, {2, 4, 2}, {5, 2, 1}, {6, 4, 3}, {0, 6, 3}, {3, 2, 1},
+  {5, 6, 4}, {3, 4, 2}, {7, 2, 2}, {1, 4, 2}, {6, 2, 2}, {0, 4, 2}, {4, 6, 4}, {2, 2, 1},
+  {6, 6, 5}, {2, 4, 3}, {3, 2, 1}, {7, 4, 4}, {0, 2, 1}, {4, 4, 3}, {5, 6, 5}, {1, 2, 1},
+  {7, 6, 6}, {6, 4, 4}, {5, 2, 2}, {4, 4, 4}, {3, 2, 2}, {2, 4, 4}, {1, 6, 6}, {0, 2, 1}
+}};
+
 } // namespace
 
 namespace primecount {
@@ -99,12 +126,24 @@ Sieve::Sieve(uint64_t low,
   // sieve_size = segment_size / 30 as each byte corresponds
   // to 30 numbers i.e. the 8 bits correspond to the
   // offsets = {1, 7, 11, 13, 17, 19, 23, 29}.
+  if (is_warm_cache())
+    take_sieve_buffer(sieve_);
   sieve_.resize(segment_size / 30);
-  wheel_.reserve(wheel_size);
-  wheel_.resize(4);
+  wheel_multiple_.reserve(wheel_size);
+  wheel_index_.reserve(wheel_size);
+  wheel_multiple_.resize(4);
+  wheel_index_.resize(4);
   allocate_counter(low);
 }
 
+Sieve::~Sieve()
+{
+  // In server mode we keep the sieve buffer
+  // alive for the next computation.
+  if (is_warm_cache())
+    put_sieve_buffer(sieve_);
+}
+
 /// Each element of the counter array contains the current
 /// number of unsieved elements in the interval:
 /// [i * counter_.dist, (i + 1) * counter_.dist[.
@@ -257,6 +296,7 @@ uint64_t Sieve::count(uint64_t start, uint64_t stop) const
     return 0;
 
   ASSERT(stop - start < segment_size());
+  LEAF_STATS(thread_leaf_stats().add_sieve_count(stop / 240 - start / 240 + 1));
 
   uint64_t start_idx = start / 240;
   uint64_t stop_idx = stop / 240;
@@ -298,7 +338,57 @@ void Sieve::add(uint64_t prime)
   // calculate wheel index of multiple
   uint32_t index = wheel_init[quotient % 30].index;
   index += wheel_offsets[prime % 30];
-  wheel_.emplace_back(multiple32, index);
+  wheel_multiple_.push_back(multiple32);
+  wheel_index_.push_back((uint8_t) index);
+}
+
+/// Add a batch of sieving primes to the sieve.
+/// For start_ < 2^52 the quotients start_ / prime are
+/// computed using double precision divisions, unlike 64-bit
+/// integer divisions these are fully pipelined by the CPU
+/// and can be vectorized by the compiler. Since start_ and prime are
+/// exactly representable as double and the division is
+/// correctly rounded, the computed quotient is either
+/// start_ / prime or start_ / prime + 1.
+///
+void Sieve::add(const uint64_t* primes, std::size_t n)
+{
+  ASSERT(n <= batch_size);
+  ASSERT(start_ % 30 == 0);
+  uint64_t quotients[batch_size];
+
+  if (start_ < (1ull << 52))
+  {
+    // Signed conversions are faster
+    double start = (double) (int64_t) start_;
+
+    for (std::size_t i = 0; i < n; i++)
+      quotients[i] = (int64_t) (start / (double) (int64_t) primes[i]);
+    for (std::size_t i = 0; i < n; i++)
+      quotients[i] -= quotients[i] * primes[i] > start_;
+  }
+  else
+  {
+    for (std::size_t i = 0; i < n; i++)
+      quotients[i] = start_ / primes[i];
+  }
+
+  uint32_t multiples[batch_size];
+  uint8_t indexes[batch_size];
+
+  // Same algorithm as add(prime)
+  for (std::size_t i = 0; i < n; i++)
+  {
+    uint64_t prime = primes[i];
+    uint64_t quotient = quotients[i] + 1;
+    const WheelInit& init = wheel_init[quotient % 30];
+    uint64_t multiple = prime * (quotient + init.factor);
+    multiples[i] = (uint32_t) ((multiple - start_) / 30);
+    indexes[i] = (uint8_t) (init.index + wheel_offsets[prime % 30]);
+  }
+
+  wheel_multiple_.insert(wheel_multiple_.end(), multiples, multiples + n);
+  wheel_index_.insert(wheel_index_.end(), indexes, indexes + n);
 }
 
 /// Remove the i-th prime and the multiples of the i-th prime
@@ -306,24 +396,31 @@ void Sieve::add(uint64_t prime)
 ///
 void Sieve::cross_off(uint64_t prime, uint64_t i)
 {
-  if (i >= wheel_.size())
+  if (i >= wheel_multiple_.size())
     add(prime);
 
+  uint64_t m = wheel_multiple_[i];
+  uint64_t sieve_size = sieve_.size();
+
+  // No multiple inside the current segment
+  if (m >= sieve_size)
+  {
+    wheel_multiple_[i] = (uint32_t) (m - sieve_size);
+    return;
+  }
+
   prime /= 30;
-  Wheel& wheel = wheel_[i];
-  uint64_t m = wheel.multiple;
   uint8_t* sieve = sieve_.data();
-  uint64_t sieve_size = sieve_.size();
 
   #define CHECK_FINISHED(wheel_index) \
     if_unlikely(m >= sieve_size) \
     { \
-      wheel.index = wheel_index; \
-      wheel.multiple = (uint32_t) (m - sieve_size); \
+      wheel_index_[i] = wheel_index; \
+      wheel_multiple_[i] = (uint32_t) (m - sieve_size); \
       return; \
     }
 
-  switch (wheel.index)
+  switch (wheel_index_[i])
   {
     for (;;)
     {
@@ -555,6 +652,76 @@ void Sieve::cross_off(uint64_t prime, uint64_t i)
   #undef CHECK_FINISHED
 }
 
+/// Cross off and count the multiples of a small sieving prime.
+/// Small primes have many multiples inside each 64-bit word of
+/// the sieve array, for these primes crossing off one multiple
+/// at a time (read-modify-write of a byte and a counter update)
+/// is slow. Since the multiples of prime repeat every prime
+/// words (240 * prime numbers) we first compute the bit mask of
+/// the multiples for each of these prime words. Then we cross
+/// off the multiples of each word of the sieve array using a
+/// single AND and count them using a single POPCNT.
+///
+void Sieve::cross_off_count_dense(uint64_t prime, uint64_t i)
+{
+  uint64_t m = wheel_multiple_[i];
+  uint64_t wheel_index = wheel_index_[i];
+  uint64_t sieve_size = sieve_.size();
+  uint64_t words = sieve_size / 8;
+  uint64_t period = min(prime, words);
+  uint64_t pattern_size = period * 8;
+  uint64_t prime30 = prime / 30;
+
+  pattern_.resize(period);
+  fill_n(pattern_.data(), period, 0);
+  auto pattern = (uint8_t*) pattern_.data();
+
+  auto next_multiple = [&]()
+  {
+    const WheelStep& step = wheel_steps[wheel_index];
+    m += prime30 * step.factor + step.correct;
+    wheel_index = (wheel_index & ~7ull) | ((wheel_index + 1) & 7);
+  };
+
+  for (; m < pattern_size; next_multiple())
+    pattern[m] |= (uint8_t) (1 << wheel_steps[wheel_index].bit);
+
+  // 8 wheel steps correspond to prime bytes, hence
+  // we can skip full wheel cycles.
+  if (m < sieve_size)
+    m += ((sieve_size - m) / prime) * prime;
+  while (m < sieve_size)
+    next_multiple();
+
+  wheel_index_[i] = (uint8_t) wheel_index;
+  wheel_multiple_[i] = (uint32_t) (m - sieve_size);
+
+  auto sieve64 = (uint64_t*) sieve_.data();
+  uint64_t counter_words = (1ull << counter_.log2_dist) / 8;
+  uint64_t total_count = total_count_;
+  uint64_t j = 0;
+
+  for (uint64_t w = 0, c = 0; w < words; c++)
+  {
+    uint64_t stop = min(w + counter_words, words);
+    uint64_t cnt = 0;
+
+    for (; w < stop; w++)
+    {
+      uint64_t word = sieve64[w];
+      uint64_t mask = pattern_[j];
+      cnt += popcnt64(word & mask);
+      sieve64[w] = word & ~mask;
+      j = (j + 1 < period) ? j + 1 : 0;
+    }
+
+    counter_[c] -= (uint32_t) cnt;
+    total_count -= cnt;
+  }
+
+  total_count_ = total_count;
+}
+
 /// Remove the i-th prime and the multiples of the i-th prime
 /// from the sieve array. Also counts the number of elements
 /// removed for the first time i.e. the count of sieved elements
@@ -562,25 +729,40 @@ void Sieve::cross_off(uint64_t prime, uint64_t i)
 ///
 void Sieve::cross_off_count(uint64_t prime, uint64_t i)
 {
-  if (i >= wheel_.size())
+  if (i >= wheel_multiple_.size())
     add(prime);
 
   reset_counter();
-  Wheel& wheel = wheel_[i];
-  prime /= 30;
+  uint64_t m = wheel_multiple_[i];
+  uint64_t sieve_size = sieve_.size();
 
-  uint64_t m = wheel.multiple;
+  // For large b most sieving primes have no multiple
+  // inside the current segment. We check this before
+  // the switch statement below as its indirect
+  // branch is often mispredicted.
+  if (m >= sieve_size)
+  {
+    wheel_multiple_[i] = (uint32_t) (m - sieve_size);
+    return;
+  }
+
+  if (prime < max_dense_prime)
+  {
+    cross_off_count_dense(prime, i);
+    return;
+  }
+
+  prime /= 30;
   uint64_t total_count = total_count_;
   uint64_t counter_log2_dist = counter_.log2_dist;
-  uint64_t sieve_size = sieve_.size();
   uint32_t* counter = &counter_[0];
   uint8_t* sieve = &sieve_[0];
 
   #define CHECK_FINISHED(wheel_index) \
     if_unlikely(m >= sieve_size) \
     { \
-      wheel.index = wheel_index; \
-      wheel.multiple = (uint32_t) (m - sieve_size); \
+      wheel_index_[i] = wheel_index; \
+      wheel_multiple_[i] = (uint32_t) (m - sieve_size); \
       total_count_ = total_count; \
       return; \
     }
@@ -594,7 +776,7 @@ void Sieve::cross_off_count(uint64_t prime, uint64_t i)
       total_count -= (uint64_t) is_bit; \
     }
 
-  switch (wheel.index)
+  switch (wheel_index_[i])
   {
     for (;;)
     {
@@ -4,6 +4,22 @@
 ///        of the formulas related to special leaves. It is used by
 ///        the D, S2_easy and S2_hard formulas.
 ///
+///        The percentage of D and S2_hard computed from sum and
+///        sum_approx is not linear in time, it often quickly reaches
+///        90% and then slows down. Hence once a few work units have
+///        completed we switch to a time-linear progress model. The
+///        runtime of sieving [low, high[ is modelled as the cost of
+///        the special leaves inside [low, high[ whose density
+///        decreases like 1 / n plus the cost of sieving, which is
+///        proportional to high - low. The 2 cost factors are fitted
+///        to the measured runtimes of the completed work units,
+///        recent work units get a higher weight. This also allows
+///        to print the estimated remaining time.
+///
+///        The worker threads only publish the current status in
+///        atomic variables, the status is printed by a separate
+///        status thread (see StatusThread.hpp).
+///
 /// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
@@ -11,13 +27,18 @@
 ///
 
 #include <StatusS2.hpp>
+#include <StatusThread.hpp>
 #include <primecount-internal.hpp>
 #include <int128_t.hpp>
 
-#include <iostream>
+#include <stdint.h>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <string>
 
 using namespace primecount;
 
@@ -48,16 +69,62 @@ double skewed_percent(T x, T y)
   return percent;
 }
 
+/// Format seconds e.g. "1d 04h", "2h 05m", "3m 07s", "9s"
+std::string format_secs(double secs)
+{
+  int64_t s = (int64_t) secs;
+  int64_t d = s / 86400;
+  int64_t h = (s / 3600) % 24;
+  int64_t m = (s / 60) % 60;
+  s %= 60;
+
+  std::ostringstream oss;
+  oss << std::setfill('0');
+
+  if (d > 0)
+    oss << d << "d " << std::setw(2) << h << 'h';
+  else if (h > 0)
+    oss << h << "h " << std::setw(2) << m << 'm';
+  else if (m > 0)
+    oss << m << "m " << std::setw(2) << s << 's';
+  else
+    oss << s << 's';
+
+  return oss.str();
+}
+
+/// The density of the special leaves decreases like 1 / n.
+/// Integrating 1 / (n + s) over [low, high[ gives the leaf
+/// weight of the interval. s = sqrt(limit) avoids that the
+/// first interval (low = 0) gets an infinite weight.
+///
+double leaf_weight(int64_t low, int64_t high, int64_t limit)
+{
+  double s = std::sqrt((double) limit);
+  return std::log((high + s) / (low + s));
+}
+
+/// Each segment is sieved with all sieving primes,
+/// hence the sieving cost grows linearly.
+///
+double sieve_weight(int64_t low, int64_t high, int64_t limit)
+{
+  return (double) (high - low) / (double) limit;
+}
+
 } // namespace
 
 namespace primecount {
 
-StatusS2::StatusS2(maxint_t x)
+StatusS2::StatusS2(maxint_t x, bool is_print)
 {
   precision_ = get_status_precision(x);
   epsilon_ = 1.0;
   for (int i = 0; i < precision_; i++)
     epsilon_ /= 10.0;
+
+  if (is_print)
+    thread_.start([this] { print_status(); });
 }
 
 /// This method is used by S2_hard() and D().
@@ -86,19 +153,180 @@ double StatusS2::getPercent(int64_t low, int64_t limit, maxint_t sum, maxint_t s
   return percent;
 }
 
-void StatusS2::print(double percent)
+/// Add a completed work unit [low, low + dist[ to the
+/// progress model. Must be called inside the critical
+/// section of LoadBalancerS2.
+///
+void StatusS2::add_work(int64_t low,
+                        int64_t dist,
+                        int64_t limit,
+                        double secs)
+{
+  if (dist <= 0 || secs < 0)
+    return;
+
+  // Older work units (near the start of the sieve
+  // interval) are less representative of the
+  // remaining work, hence we slowly forget them.
+  double decay = 0.99;
+  double l = leaf_weight(low, low + dist, limit);
+  double s = sieve_weight(low, low + dist, limit);
+  sum_ll_ = sum_ll_ * decay + l * l;
+  sum_ls_ = sum_ls_ * decay + l * s;
+  sum_ss_ = sum_ss_ * decay + s * s;
+  sum_lt_ = sum_lt_ * decay + l * secs;
+  sum_st_ = sum_st_ * decay + s * secs;
+  done_sieve_ += s;
+  done_secs_ += secs;
+  units_++;
+}
+
+bool StatusS2::is_calibrated() const
 {
+  return units_ >= 8 && (sum_lt_ > 0 || sum_st_ > 0);
+}
+
+/// Least squares fit of:
+/// secs = a * leaf_weight + b * sieve_weight.
+/// Near the start of the sieve interval the runtime is
+/// dominated by the special leaves and the sieving cost
+/// factor cannot be measured accurately. Since the sieving
+/// cost is extrapolated to the entire remaining sieve
+/// interval, we only fit the leaf cost until 1% of the
+/// sieve interval has been processed (and if a cost factor
+/// would be negative).
+///
+void StatusS2::fit(double& a, double& b) const
+{
+  a = 0;
+  b = 0;
+
+  if (sum_ll_ <= 0)
+    return;
+
+  double det = sum_ll_ * sum_ss_ - sum_ls_ * sum_ls_;
+
+  if (done_sieve_ >= 0.01 &&
+      det > 0.01 * sum_ll_ * sum_ss_)
+  {
+    a = (sum_lt_ * sum_ss_ - sum_st_ * sum_ls_) / det;
+    b = (sum_st_ * sum_ll_ - sum_lt_ * sum_ls_) / det;
+
+    if (a >= 0 && b >= 0)
+      return;
+  }
+
+  a = std::max(0.0, sum_lt_ / sum_ll_);
+  b = 0;
+}
+
+/// Estimated CPU seconds needed to process [low, limit[
+double StatusS2::remaining_work(int64_t low, int64_t limit) const
+{
+  if (low >= limit)
+    return 0;
+
+  double a, b;
+  fit(a, b);
+
+  return a * leaf_weight(low, limit, limit) +
+         b * sieve_weight(low, limit, limit);
+}
+
+/// Time-linear percentage, requires is_calibrated()
+double StatusS2::getPercent(int64_t low, int64_t limit) const
+{
+  double rem = remaining_work(low, limit);
+  double percent = 100 * done_secs_ / (done_secs_ + rem);
+  return in_between(0, percent, 100);
+}
+
+/// Estimated remaining (wall clock) seconds,
+/// returns -1 if not yet calibrated.
+///
+double StatusS2::getRemainingSecs(int64_t low, int64_t limit) const
+{
+  if (!is_calibrated())
+    return -1;
+
+  return remaining_work(low, limit) / threads_;
+}
+
+/// Called by the status thread every 0.1 seconds
+void StatusS2::print_status()
+{
+  double percent = status_percent_.load(std::memory_order_relaxed);
+  double remaining_secs = status_secs_.load(std::memory_order_relaxed);
+
+  if (percent >= 0)
+    print(percent, remaining_secs);
+}
+
+void StatusS2::print(double percent, double remaining_secs)
+{
+  // Only the time-linear progress model computes the
+  // remaining time. The percentage computed from sum and
+  // sum_approx usually runs ahead of the time-linear
+  // percentage, hence when switching to the time-linear
+  // model we restart from its (lower) percentage.
+  bool is_time_linear = remaining_secs >= 0;
+  if (is_time_linear != is_time_linear_)
+  {
+    is_time_linear_ = is_time_linear;
+    percent_ = -1;
+  }
+
   double old = percent_;
 
-  if ((percent - old) >= epsilon_)
+  // The remaining time must be updated even if
+  // the percentage did not change. The printed
+  // percentage never decreases while the same
+  // progress model is used.
+  if ((percent - old) >= epsilon_ ||
+      remaining_secs >= 0)
   {
+    percent = std::max(percent, old);
     percent_ = percent;
     std::ostringstream status;
     status << "\rStatus: " << std::fixed << std::setprecision(precision_) << percent << '%';
+
+    // Trailing spaces overwrite the previous
+    // (possibly longer) status text.
+    if (remaining_secs >= 0)
+      status << ", ETA: " << format_secs(remaining_secs) << "    ";
+
     std::cout << status.str() << std::flush;
   }
 }
 
+/// Reading the coarse clock is much cheaper than reading
+/// std::chrono::steady_clock, this matters because the
+/// status is updated after each (possibly tiny) work unit.
+///
+bool StatusS2::is_publish()
+{
+  double time = get_time_coarse();
+  double old = time_;
+
+  if ((time - old) >= threshold_)
+  {
+    time_ = time;
+    return true;
+  }
+
+  return false;
+}
+
+/// Publish the current status for the status thread.
+/// This only writes 2 atomic variables, hence the
+/// calling worker thread never blocks on I/O.
+///
+void StatusS2::publish(double percent, double remaining_secs)
+{
+  status_secs_.store(remaining_secs, std::memory_order_relaxed);
+  status_percent_.store(percent, std::memory_order_relaxed);
+}
+
 /// This method is used by S2_hard() and D().
 /// This method does not use a lock to synchronize threads
 /// as it is only used inside of a critical section inside
@@ -107,14 +335,19 @@ void StatusS2::print(double percent)
 ///
 void StatusS2::print(int64_t low, int64_t limit, maxint_t sum, maxint_t sum_approx)
 {
-  double time = get_time();
-  double old = time_;
-
-  if ((time - old) >= threshold_)
+  if (is_publish())
   {
-    time_ = time;
-    double percent = getPercent(low, limit, sum, sum_approx);
-    print(percent);
+    if (is_calibrated())
+    {
+      double percent = getPercent(low, limit);
+      double remaining_secs = getRemainingSecs(low, limit);
+      publish(percent, remaining_secs);
+    }
+    else
+    {
+      double percent = getPercent(low, limit, sum, sum_approx);
+      publish(percent);
+    }
   }
 }
 
@@ -124,14 +357,10 @@ void StatusS2::print(int64_t low, int64_t limit, maxint_t sum, maxint_t sum_appr
 ///
 void StatusS2::print(int64_t b, int64_t max_b)
 {
-  double time = get_time();
-  double old = time_;
-
-  if ((time - old) >= threshold_)
+  if (is_publish())
   {
-    time_ = time;
     double percent = skewed_percent(b, max_b);
-    print(percent);
+    publish(percent);
   }
 }
 
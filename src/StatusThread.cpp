@@ -0,0 +1,71 @@
+///
+/// @file  StatusThread.cpp
+/// @brief The status thread sleeps most of the time, it wakes up
+///        every 0.1 seconds to print the current status. When
+///        the computation is finished the status is printed one
+///        last time so that the final progress is not lost.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <StatusThread.hpp>
+
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace primecount {
+
+StatusThread::~StatusThread()
+{
+  stop();
+}
+
+/// Start printing the status in a background thread.
+/// The print function must only read atomic variables
+/// (or other thread-safe state).
+///
+void StatusThread::start(std::function<void()> print)
+{
+  stop();
+  print_ = std::move(print);
+  is_stop_ = false;
+  thread_ = std::thread(&StatusThread::run, this);
+}
+
+/// Print the status a last time and join the thread
+void StatusThread::stop()
+{
+  if (!thread_.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stop_ = true;
+  }
+
+  cond_.notify_one();
+  thread_.join();
+}
+
+void StatusThread::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool is_stop = false;
+
+  while (!is_stop)
+  {
+    is_stop = cond_.wait_for(lock, interval_, [&] { return is_stop_; });
+
+    // Don't hold the lock while printing
+    lock.unlock();
+    print_();
+    lock.lock();
+  }
+}
+
+} // namespace
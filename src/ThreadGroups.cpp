@@ -0,0 +1,93 @@
+///
+/// @file  ThreadGroups.cpp
+/// @brief Partition the threads of a parallel computation into
+///        groups, see ThreadGroups.hpp.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <ThreadGroups.hpp>
+#include <primecount-config.hpp>
+#include <imath.hpp>
+#include <macros.hpp>
+#include <parallel.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+std::atomic<int> threads_per_group_(THREADS_PER_GROUP);
+std::atomic<int64_t> group_chunks_(0);
+
+} // namespace
+
+namespace primecount {
+
+void set_threads_per_group(int threads)
+{
+  threads_per_group_ = std::max(threads, 1);
+}
+
+int get_threads_per_group()
+{
+  return threads_per_group_;
+}
+
+int64_t get_group_chunks()
+{
+  return group_chunks_;
+}
+
+void GroupChunk::assign(int64_t chunk_low,
+                        int64_t chunk_high,
+                        int64_t chunk_unit_size)
+{
+  low = chunk_low;
+  high = chunk_high;
+  unit_size = chunk_unit_size;
+
+  if (high - low > unit_size)
+    group_chunks_++;
+}
+
+/// The groups are never smaller than threads_per_group,
+/// except for the last group. If is_enabled is false
+/// (e.g. when the work units are recorded) all threads
+/// are in the same group.
+///
+void ThreadGroups::init(int threads,
+                        bool is_enabled)
+{
+  threads_ = std::max(threads, 1);
+  threads_per_group_ = get_threads_per_group();
+
+  if (is_enabled && threads_ > threads_per_group_)
+    groups_ = ceil_div(threads_, threads_per_group_);
+  else
+  {
+    groups_ = 1;
+    threads_per_group_ = threads_;
+  }
+}
+
+int ThreadGroups::threads(int group) const
+{
+  ASSERT(group >= 0 && group < groups_);
+  int first = group * threads_per_group_;
+  return std::min(threads_per_group_, threads_ - first);
+}
+
+int ThreadGroups::get_group() const
+{
+  if (groups_ == 1)
+    return 0;
+
+  int group = get_thread_num() / threads_per_group_;
+  return std::min(group, groups_ - 1);
+}
+
+} // namespace
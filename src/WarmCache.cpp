@@ -0,0 +1,84 @@
+///
+/// @file  WarmCache.cpp
+/// @brief Data structures that are kept alive in between
+///        computations in server mode (primecount --stdin).
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <WarmCache.hpp>
+#include <PiTable.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace primecount;
+
+bool warm_cache_ = false;
+
+std::mutex pi_mutex_;
+std::shared_ptr<const PiTable> pi_table_;
+
+std::mutex sieve_mutex_;
+std::vector<Vector<uint8_t>> sieve_buffers_;
+
+} // namespace
+
+namespace primecount {
+
+void set_warm_cache(bool enable)
+{
+  warm_cache_ = enable;
+}
+
+bool is_warm_cache()
+{
+  return warm_cache_;
+}
+
+std::shared_ptr<const PiTable> get_pi_table(uint64_t max_x, int threads)
+{
+  if (!is_warm_cache())
+    return std::make_shared<const PiTable>(max_x, threads);
+
+  std::lock_guard<std::mutex> lock(pi_mutex_);
+
+  if (!pi_table_ ||
+      pi_table_->size() < max_x + 1)
+  {
+    // Free the old PiTable (unless it is still used
+    // by another thread) before allocating a new one.
+    pi_table_.reset();
+    pi_table_ = std::make_shared<const PiTable>(max_x, threads);
+  }
+
+  return pi_table_;
+}
+
+void take_sieve_buffer(Vector<uint8_t>& sieve)
+{
+  std::lock_guard<std::mutex> lock(sieve_mutex_);
+
+  if (!sieve_buffers_.empty())
+  {
+    sieve.swap(sieve_buffers_.back());
+    sieve_buffers_.pop_back();
+  }
+}
+
+void put_sieve_buffer(Vector<uint8_t>& sieve)
+{
+  std::lock_guard<std::mutex> lock(sieve_mutex_);
+  sieve_buffers_.emplace_back(std::move(sieve));
+}
+
+} // namespace
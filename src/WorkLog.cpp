@@ -0,0 +1,183 @@
+///
+/// @file  WorkLog.cpp
+/// @brief Record and replay the work units that the load balancers
+///        assign to the threads, see WorkLog.hpp. Log file format:
+///
+///        # Comment
+///        LoadBalancerS2 <limit> <units>
+///        <low> <segments> <segment_size>
+///        ...
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <WorkLog.hpp>
+#include <primecount.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace primecount;
+
+/// Work units of one load balancer
+struct WorkLogBlock
+{
+  std::string name;
+  int64_t limit = 0;
+  Vector<WorkUnit> units;
+};
+
+LoadBalancingMode load_balancing_ = LOAD_BALANCING_ADAPTIVE;
+std::string filename_;
+std::vector<WorkLogBlock> blocks_;
+std::size_t next_block_ = 0;
+
+/// Read the next non-empty line that is not a comment
+bool next_line(std::ifstream& file, std::string& line)
+{
+  while (std::getline(file, line))
+    if (!line.empty() && line[0] != '#')
+      return true;
+
+  return false;
+}
+
+void load_blocks(const std::string& filename)
+{
+  std::ifstream file(filename);
+  if (!file)
+    throw primecount_error("failed to open file: " + filename);
+
+  blocks_.clear();
+  next_block_ = 0;
+  std::string line;
+
+  while (next_line(file, line))
+  {
+    WorkLogBlock block;
+    std::size_t size = 0;
+    std::istringstream header(line);
+
+    if (!(header >> block.name >> block.limit >> size))
+      throw primecount_error("invalid load balancing log: " + filename);
+
+    block.units.resize(size);
+
+    for (WorkUnit& unit : block.units)
+    {
+      if (!next_line(file, line))
+        throw primecount_error("truncated load balancing log: " + filename);
+
+      std::istringstream iss(line);
+      if (!(iss >> unit.low >> unit.segments >> unit.segment_size))
+        throw primecount_error("invalid load balancing log: " + filename);
+    }
+
+    blocks_.push_back(std::move(block));
+  }
+}
+
+} // namespace
+
+namespace primecount {
+
+void set_load_balancing(LoadBalancingMode mode,
+                        const std::string& filename)
+{
+  if (mode == LOAD_BALANCING_RECORD)
+  {
+    // Truncate the log file
+    std::ofstream file(filename);
+    if (!file)
+      throw primecount_error("failed to open file: " + filename);
+    file << "# primecount load balancing log\n";
+  }
+
+  if (mode == LOAD_BALANCING_REPLAY)
+    load_blocks(filename);
+
+  load_balancing_ = mode;
+  filename_ = filename;
+}
+
+LoadBalancingMode get_load_balancing()
+{
+  return load_balancing_;
+}
+
+WorkLog::WorkLog(const std::string& name, int64_t limit) :
+  name_(name),
+  limit_(limit),
+  mode_(load_balancing_)
+{
+  if (is_replay())
+  {
+    if (next_block_ >= blocks_.size())
+      throw primecount_error("load balancing log: no more entries for " + name);
+
+    WorkLogBlock& block = blocks_[next_block_++];
+
+    // The log must have been recorded using the same x
+    // and the same sequence of load balancers.
+    if (block.name != name || block.limit != limit)
+      throw primecount_error("load balancing log does not match: " + name);
+
+    units_ = std::move(block.units);
+  }
+
+  // Open the log file before computing, so that
+  // we don't lose the work units at the end.
+  if (is_record())
+  {
+    file_.open(filename_, std::ios::app);
+    if (!file_)
+      throw primecount_error("failed to open file: " + filename_);
+  }
+}
+
+/// In record mode the work units are appended to the
+/// log file once the load balancer has finished. We
+/// cannot throw an exception in the destructor, hence
+/// write errors are reported on stderr.
+///
+WorkLog::~WorkLog()
+{
+  if (is_record())
+  {
+    file_ << name_ << " " << limit_ << " " << units_.size() << "\n";
+
+    for (const WorkUnit& unit : units_)
+      file_ << unit.low << " " << unit.segments << " " << unit.segment_size << "\n";
+
+    file_.flush();
+    if (!file_)
+      std::cerr << "primecount: failed to write load balancing log: " << filename_ << std::endl;
+  }
+}
+
+void WorkLog::record(const WorkUnit& unit)
+{
+  units_.push_back(unit);
+}
+
+bool WorkLog::replay(WorkUnit& unit)
+{
+  if (next_ >= units_.size())
+    return false;
+
+  unit = units_[next_++];
+  return true;
+}
+
+} // namespace
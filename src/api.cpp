@@ -2,7 +2,7 @@
 /// @file  api.cpp
 ///        primecount's C++ API.
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -14,24 +14,47 @@
 #include <gourdon.hpp>
 #include <int128_t.hpp>
 #include <macros.hpp>
+#include <parallel.hpp>
+#include <PiStore.hpp>
 #include <PiTable.hpp>
 #include <print.hpp>
 #include <to_string.hpp>
 
 #include <cmath>
 #include <limits>
+#include <sstream>
 #include <string>
 #include <stdint.h>
 
-#ifdef _OPENMP
-  #include <omp.h>
-#endif
-
 namespace {
 
-#ifdef _OPENMP
-  int threads_ = 0;
-#endif
+using namespace primecount;
+
+int threads_ = 0;
+
+/// Look up pi(x) in the pi(x) store, if not found
+/// compute pi(x) using Gourdon's algorithm and
+/// store the result together with its parameters.
+///
+template <typename T, typename F>
+T pi_gourdon_store(T x, F pi_gourdon)
+{
+  maxint_t pix;
+  if (pi_store_lookup(x, pix))
+    return (T) pix;
+
+  T res = pi_gourdon();
+
+  if (is_pi_store())
+  {
+    auto alpha = get_alpha_gourdon(x);
+    std::ostringstream algorithm;
+    algorithm << "gourdon alpha_y=" << alpha.first << " alpha_z=" << alpha.second;
+    pi_store_insert(x, res, algorithm.str());
+  }
+
+  return res;
+}
 
 } // namespace
 
@@ -54,6 +77,11 @@ int64_t pi(int64_t x)
   return pi(x, get_num_threads());
 }
 
+int64_t pi(int64_t x, int64_t q, int64_t a)
+{
+  return pi_lmo_mod(x, q, a, get_num_threads());
+}
+
 int64_t pi(int64_t x, int threads)
 {
   // Compute pi(x) in O(1) for small values of x
@@ -69,7 +97,7 @@ int64_t pi(int64_t x, int threads)
     return pi_meissel(x, threads);
 
   // For large x Gourdon's algorithm runs fastest
-  return pi_gourdon_64(x, threads);
+  return pi_gourdon_store(x, [&] { return pi_gourdon_64(x, threads); });
 }
 
 /// Used internally for initialization
@@ -84,7 +112,7 @@ int64_t pi_noprint(int64_t x, int threads)
   else if (x <= (int64_t) 1e8)
     return pi_meissel(x, threads, is_print);
   else
-    return pi_gourdon_64(x, threads, is_print);
+    return pi_gourdon_store(x, [&] { return pi_gourdon_64(x, threads, is_print); });
 }
 
 int64_t pi_cache(int64_t x, bool is_print)
@@ -132,7 +160,7 @@ int128_t pi(int128_t x, int threads)
   if (x <= std::numeric_limits<int64_t>::max())
     return pi((int64_t) x, threads);
   else
-    return pi_gourdon_128(x, threads);
+    return pi_gourdon_store(x, [&] { return pi_gourdon_128(x, threads); });
 }
 
 int128_t pi_deleglise_rivat(int128_t x, int threads)
@@ -170,6 +198,70 @@ int64_t nth_prime(int64_t n)
   return nth_prime(n, get_num_threads());
 }
 
+int64_t semiprime_count(int64_t x)
+{
+  return semiprime_count(x, get_num_threads());
+}
+
+std::string semiprime_count(const std::string& x)
+{
+  maxint_t n = to_maxint(x);
+  maxint_t res = semiprime_count(n, get_num_threads());
+  return to_string(res);
+}
+
+int64_t mertens(int64_t x)
+{
+  return mertens(x, get_num_threads());
+}
+
+std::string mertens(const std::string& x)
+{
+  maxint_t n = to_maxint(x);
+  maxint_t res = mertens(n, get_num_threads());
+  return to_string(res);
+}
+
+std::string prime_sum(int64_t x)
+{
+  maxint_t res = prime_sum(x, get_num_threads());
+  return to_string(res);
+}
+
+std::string prime_sum(const std::string& x)
+{
+  maxint_t n = to_maxint(x);
+  maxint_t res = prime_sum(n, get_num_threads());
+  return to_string(res);
+}
+
+maxint_t prime_sum(int64_t x, int threads)
+{
+  // For x <= 10^7 the sieve of Eratosthenes runs fastest
+  if (x <= (int64_t) 1e7)
+    return prime_sum_primesieve(x);
+  else
+    return prime_sum_lmo(x, threads);
+}
+
+#ifdef HAVE_INT128_T
+
+int128_t prime_sum(int128_t x, int threads)
+{
+  // Prevent 64-bit cast to random
+  // integer if x <= -2^63.
+  if (x < 0)
+    return 0;
+
+  // Use 64-bit if possible
+  if (x <= std::numeric_limits<int64_t>::max())
+    return prime_sum((int64_t) x, threads);
+  else
+    return prime_sum_lmo(x, threads);
+}
+
+#endif
+
 int64_t phi(int64_t x, int64_t a)
 {
   return phi(x, a, get_num_threads());
@@ -210,21 +302,15 @@ std::string get_max_x()
 
 int get_num_threads()
 {
-#ifdef _OPENMP
   if (threads_)
     return threads_;
   else
-    return std::max(1, omp_get_max_threads());
-#else
-  return 1;
-#endif
+    return get_max_threads();
 }
 
 void set_num_threads(int threads)
 {
-#ifdef _OPENMP
-  threads_ = in_between(1, threads, omp_get_max_threads());
-#endif
+  threads_ = in_between(1, threads, get_max_threads());
   primesieve::set_num_threads(threads);
 }
 
@@ -2,7 +2,7 @@
 /// @file  api_c.cpp
 ///        primecount's C API.
 ///
-/// Copyright (C) 2020 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -84,6 +84,162 @@ int64_t primecount_nth_prime(int64_t n)
   }
 }
 
+int64_t primecount_pi_mod(int64_t x, int64_t q, int64_t a)
+{
+  try
+  {
+    return primecount::pi(x, q, a);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_pi_mod: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int64_t primecount_semiprime_count(int64_t x)
+{
+  try
+  {
+    return primecount::semiprime_count(x);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_semiprime_count: " << e.what() << std::endl;
+    return -1;
+  }
+}
+
+int primecount_semiprime_count_str(const char* x, char* res, size_t len)
+{
+  try
+  {
+    if (!x)
+      throw primecount::primecount_error("x must not be a NULL pointer");
+
+    if (!res)
+      throw primecount::primecount_error("res must not be a NULL pointer");
+
+    std::string str(x);
+    std::string count = primecount::semiprime_count(str);
+
+    // +1 required to add null at the end of the string
+    if (len < count.length() + 1)
+    {
+      std::ostringstream oss;
+      oss << "res buffer too small, res.len = " << len << " < required = " << count.length() + 1;
+      throw primecount::primecount_error(oss.str());
+    }
+
+    count.copy(res, count.length());
+    // std::string::copy does not append a null character
+    // at the end of the copied content.
+    res[count.length()] = '\0';
+
+    return (int) count.length();
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_semiprime_count_str: " << e.what() << std::endl;
+
+    if (res && len > 0)
+      res[0] = '\0';
+
+    return -1;
+  }
+}
+
+int64_t primecount_mertens(int64_t x)
+{
+  try
+  {
+    return primecount::mertens(x);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_mertens: " << e.what() << std::endl;
+    return INT64_MIN;
+  }
+}
+
+int primecount_mertens_str(const char* x, char* res, size_t len)
+{
+  try
+  {
+    if (!x)
+      throw primecount::primecount_error("x must not be a NULL pointer");
+
+    if (!res)
+      throw primecount::primecount_error("res must not be a NULL pointer");
+
+    std::string str(x);
+    std::string mertens = primecount::mertens(str);
+
+    // +1 required to add null at the end of the string
+    if (len < mertens.length() + 1)
+    {
+      std::ostringstream oss;
+      oss << "res buffer too small, res.len = " << len << " < required = " << mertens.length() + 1;
+      throw primecount::primecount_error(oss.str());
+    }
+
+    mertens.copy(res, mertens.length());
+    // std::string::copy does not append a null character
+    // at the end of the copied content.
+    res[mertens.length()] = '\0';
+
+    return (int) mertens.length();
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_mertens_str: " << e.what() << std::endl;
+
+    if (res && len > 0)
+      res[0] = '\0';
+
+    return -1;
+  }
+}
+
+int primecount_prime_sum_str(const char* x, char* res, size_t len)
+{
+  try
+  {
+    if (!x)
+      throw primecount::primecount_error("x must not be a NULL pointer");
+
+    if (!res)
+      throw primecount::primecount_error("res must not be a NULL pointer");
+
+    std::string str(x);
+    std::string sum = primecount::prime_sum(str);
+
+    // +1 required to add null at the end of the string
+    if (len < sum.length() + 1)
+    {
+      std::ostringstream oss;
+      oss << "res buffer too small, res.len = " << len << " < required = " << sum.length() + 1;
+      throw primecount::primecount_error(oss.str());
+    }
+
+    sum.copy(res, sum.length());
+    // std::string::copy does not append a null character
+    // at the end of the copied content.
+    res[sum.length()] = '\0';
+
+    return (int) sum.length();
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << "primecount_prime_sum_str: " << e.what() << std::endl;
+
+    if (res && len > 0)
+      res[0] = '\0';
+
+    return -1;
+  }
+}
+
 int64_t primecount_phi(int64_t x, int64_t a)
 {
   try
@@ -25,6 +25,9 @@
 #include <primecount.hpp>
 #include <primecount-internal.hpp>
 #include <Vector.hpp>
+#include <WorkLog.hpp>
+#include <ElasticThreads.hpp>
+#include <ThreadGroups.hpp>
 #include <print.hpp>
 #include <int128_t.hpp>
 
@@ -214,6 +217,18 @@ void CmdOptions::optionStatus(Option& opt)
     set_status_precision(opt.to<int>());
 }
 
+/// Write the special leaf statistics to a CSV
+/// or JSON file after the computation.
+///
+void CmdOptions::optionLeafStats(Option& opt)
+{
+#if defined(ENABLE_LEAF_STATS)
+  leafStatsFile = opt.val;
+#else
+  throw primecount_error("option " + opt.opt + " requires building primecount with -DWITH_LEAF_STATS=ON");
+#endif
+}
+
 CmdOptions parseOptions(int argc, char* argv[])
 {
   // No command-line options provided
@@ -239,7 +254,11 @@ CmdOptions parseOptions(int argc, char* argv[])
     { "--help", std::make_pair(OPTION_HELP, NO_PARAM) },
     { "-l", std::make_pair(OPTION_LEGENDRE, NO_PARAM) },
     { "--legendre", std::make_pair(OPTION_LEGENDRE, NO_PARAM) },
+    { "--leaf-stats", std::make_pair(OPTION_LEAF_STATS, REQUIRED_PARAM) },
     { "--lehmer", std::make_pair(OPTION_LEHMER, NO_PARAM) },
+    { "--lb-record", std::make_pair(OPTION_LB_RECORD, REQUIRED_PARAM) },
+    { "--lb-replay", std::make_pair(OPTION_LB_REPLAY, REQUIRED_PARAM) },
+    { "--lb-static", std::make_pair(OPTION_LB_STATIC, NO_PARAM) },
     { "--lmo", std::make_pair(OPTION_LMO, NO_PARAM) },
     { "--lmo1", std::make_pair(OPTION_LMO1, NO_PARAM) },
     { "--lmo2", std::make_pair(OPTION_LMO2, NO_PARAM) },
@@ -248,17 +267,20 @@ CmdOptions parseOptions(int argc, char* argv[])
     { "--lmo5", std::make_pair(OPTION_LMO5, NO_PARAM) },
     { "-m", std::make_pair(OPTION_MEISSEL, NO_PARAM) },
     { "--meissel", std::make_pair(OPTION_MEISSEL, NO_PARAM) },
+    { "--mertens", std::make_pair(OPTION_MERTENS, NO_PARAM) },
     { "-n", std::make_pair(OPTION_NTHPRIME, NO_PARAM) },
     { "--nth-prime", std::make_pair(OPTION_NTHPRIME, NO_PARAM) },
     { "--number", std::make_pair(OPTION_NUMBER, REQUIRED_PARAM) },
     { "-p", std::make_pair(OPTION_PRIMESIEVE, NO_PARAM) },
     { "--primesieve", std::make_pair(OPTION_PRIMESIEVE, NO_PARAM) },
+    { "--prime-sum", std::make_pair(OPTION_PRIME_SUM, NO_PARAM) },
     { "--Li", std::make_pair(OPTION_LI, NO_PARAM) },
     { "--Li-inverse", std::make_pair(OPTION_LIINV, NO_PARAM) },
     { "-R", std::make_pair(OPTION_R, NO_PARAM) },
     { "--RiemannR", std::make_pair(OPTION_R, NO_PARAM) },
     { "--RiemannR-inverse", std::make_pair(OPTION_R_INVERSE, NO_PARAM) },
     { "--phi", std::make_pair(OPTION_PHI, NO_PARAM) },
+    { "--pi-mod", std::make_pair(OPTION_PI_MOD, NO_PARAM) },
     { "--P2", std::make_pair(OPTION_P2, NO_PARAM) },
     { "--S1", std::make_pair(OPTION_S1, NO_PARAM) },
     { "--S2-easy", std::make_pair(OPTION_S2_EASY, NO_PARAM) },
@@ -271,12 +293,18 @@ CmdOptions parseOptions(int argc, char* argv[])
     { "--D", std::make_pair(OPTION_D, NO_PARAM) },
     { "--Phi0", std::make_pair(OPTION_PHI0, NO_PARAM) },
     { "--Sigma", std::make_pair(OPTION_SIGMA, NO_PARAM) },
+    { "--semiprimes", std::make_pair(OPTION_SEMIPRIMES, NO_PARAM) },
+    { "--server", std::make_pair(OPTION_SERVER, NO_PARAM) },
+    { "--stdin", std::make_pair(OPTION_SERVER, NO_PARAM) },
     { "-s", std::make_pair(OPTION_STATUS, OPTIONAL_PARAM) },
     { "--status", std::make_pair(OPTION_STATUS, OPTIONAL_PARAM) },
+    { "--store", std::make_pair(OPTION_STORE, REQUIRED_PARAM) },
     { "--test", std::make_pair(OPTION_TEST, NO_PARAM) },
     { "--time", std::make_pair(OPTION_TIME, NO_PARAM) },
     { "-t", std::make_pair(OPTION_THREADS, REQUIRED_PARAM) },
     { "--threads", std::make_pair(OPTION_THREADS, REQUIRED_PARAM) },
+    { "--threads-file", std::make_pair(OPTION_THREADS_FILE, REQUIRED_PARAM) },
+    { "--threads-per-group", std::make_pair(OPTION_THREADS_PER_GROUP, REQUIRED_PARAM) },
     { "-v", std::make_pair(OPTION_VERSION, NO_PARAM) },
     { "--version", std::make_pair(OPTION_VERSION, NO_PARAM) }
   };
@@ -295,9 +323,17 @@ CmdOptions parseOptions(int argc, char* argv[])
       case OPTION_ALPHA_Y: set_alpha_y(opt.to<double>()); break;
       case OPTION_ALPHA_Z: set_alpha_z(opt.to<double>()); break;
       case OPTION_NUMBER:  numbers.push_back(opt.to<maxint_t>()); break;
+      case OPTION_SERVER:  opts.server = true; break;
       case OPTION_THREADS: set_num_threads(opt.to<int>()); break;
+      case OPTION_THREADS_FILE: set_threads_file(opt.val); break;
+      case OPTION_THREADS_PER_GROUP: set_threads_per_group(opt.to<int>()); break;
       case OPTION_HELP:    help(/* exitCode */ 0); break;
       case OPTION_STATUS:  opts.optionStatus(opt); break;
+      case OPTION_STORE:   set_pi_store(opt.val); break;
+      case OPTION_LEAF_STATS: opts.optionLeafStats(opt); break;
+      case OPTION_LB_RECORD: set_load_balancing(LOAD_BALANCING_RECORD, opt.val); break;
+      case OPTION_LB_REPLAY: set_load_balancing(LOAD_BALANCING_REPLAY, opt.val); break;
+      case OPTION_LB_STATIC: set_load_balancing(LOAD_BALANCING_STATIC); break;
       case OPTION_TIME:    opts.time = true; break;
       case OPTION_TEST:    test(); break;
       case OPTION_VERSION: version(); break;
@@ -305,6 +341,14 @@ CmdOptions parseOptions(int argc, char* argv[])
     }
   }
 
+  // In server mode the numbers are read from stdin
+  if (opts.server)
+  {
+    if (!numbers.empty())
+      throw primecount_error("option --server does not accept x numbers");
+    return opts;
+  }
+
   if (opts.option == OPTION_PHI)
   {
     if (numbers.size() < 2)
@@ -312,6 +356,14 @@ CmdOptions parseOptions(int argc, char* argv[])
     opts.a = numbers[1];
   }
 
+  if (opts.option == OPTION_PI_MOD)
+  {
+    if (numbers.size() < 3)
+      throw primecount_error("option --pi-mod requires 3 numbers");
+    opts.q = numbers[1];
+    opts.a = numbers[2];
+  }
+
   if (numbers.empty())
     throw primecount_error("missing x number");
 
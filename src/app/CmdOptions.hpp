@@ -34,7 +34,11 @@ enum OptionID
   OPTION_GOURDON_128,
   OPTION_HELP,
   OPTION_LEGENDRE,
+  OPTION_LEAF_STATS,
   OPTION_LEHMER,
+  OPTION_LB_RECORD,
+  OPTION_LB_REPLAY,
+  OPTION_LB_STATIC,
   OPTION_LMO,
   OPTION_LMO1,
   OPTION_LMO2,
@@ -42,14 +46,17 @@ enum OptionID
   OPTION_LMO4,
   OPTION_LMO5,
   OPTION_MEISSEL,
+  OPTION_MERTENS,
   OPTION_NTHPRIME,
   OPTION_NUMBER,
   OPTION_PRIMESIEVE,
+  OPTION_PRIME_SUM,
   OPTION_LI,
   OPTION_LIINV,
   OPTION_R,
   OPTION_R_INVERSE,
   OPTION_PHI,
+  OPTION_PI_MOD,
   OPTION_P2,
   OPTION_S1,
   OPTION_S2_EASY,
@@ -60,10 +67,15 @@ enum OptionID
   OPTION_D,
   OPTION_PHI0,
   OPTION_SIGMA,
+  OPTION_SEMIPRIMES,
+  OPTION_SERVER,
   OPTION_STATUS,
+  OPTION_STORE,
   OPTION_TEST,
   OPTION_TIME,
   OPTION_THREADS,
+  OPTION_THREADS_FILE,
+  OPTION_THREADS_PER_GROUP,
   OPTION_VERSION
 };
 
@@ -97,13 +109,17 @@ struct CmdOptions
 {
   std::string stressTestMode;
   std::string optionStr;
+  std::string leafStatsFile;
   int option = OPTION_DEFAULT;
   maxint_t x = -1;
   int64_t a = -1;
+  int64_t q = -1;
   bool time = false;
+  bool server = false;
 
   void setMainOption(OptionID optionID, const std::string& optStr);
   void optionStatus(Option& opt);
+  void optionLeafStats(Option& opt);
 };
 
 CmdOptions parseOptions(int, char**);
@@ -27,23 +27,42 @@ void help(int exitCode)
     "  -g, --gourdon            Count primes using Xavier Gourdon's algorithm.\n"
     "                           This is the default algorithm.\n"
     "  -l, --legendre           Count primes using Legendre's formula\n"
+    "      --leaf-stats=FILE    Write special leaf statistics to a CSV (or\n"
+    "                           .json) file, requires -DWITH_LEAF_STATS=ON\n"
     "      --lehmer             Count primes using Lehmer's formula\n"
+    "      --lb-record=FILE     Record the load balancer's work units to FILE\n"
+    "      --lb-replay=FILE     Replay the work units recorded in FILE\n"
+    "      --lb-static          Use a static (deterministic) load balancing\n"
     "      --lmo                Count primes using Lagarias-Miller-Odlyzko\n"
     "  -m, --meissel            Count primes using Meissel's formula\n"
+    "      --mertens            Compute the Mertens function M(x)\n"
     "      --Li                 Eulerian logarithmic integral function\n"
     "      --Li-inverse         Approximate the nth prime using Li^-1(x)\n"
     "  -n, --nth-prime          Calculate the nth prime\n"
     "  -p, --primesieve         Count primes using the sieve of Eratosthenes\n"
+    "      --prime-sum          Sum of the primes <= x\n"
     "      --phi <X> <A>        phi(x, a) counts the numbers <= x that are not\n"
     "                           divisible by any of the first a primes\n"
+    "      --pi-mod <X> <Q> <A> Count the primes <= x with p ≡ a (mod q),\n"
+    "                           q <= 1000\n"
     "  -R, --RiemannR           Approximate pi(x) using the Riemann R function\n"
     "      --RiemannR-inverse   Approximate the nth prime using R^-1(x)\n"
+    "      --semiprimes         Count the semiprimes <= x\n"
+    "      --server, --stdin    Read one x number (or expression) per line\n"
+    "                           from stdin and print the results\n"
+    "      --store=FILE         Reuse the pi(x) results stored in FILE and\n"
+    "                           append new results to FILE\n"
     "  -s, --status[=NUM]       Show computation progress 1%, 2%, 3%, ...\n"
     "                           Set digits after decimal point: -s1 prints 99.9%\n"
     "      --test               Run various correctness tests and exit\n"
     "      --time               Print the time elapsed in seconds\n"
     "  -t, --threads=NUM        Set the number of threads, 1 <= NUM <= CPU cores.\n"
     "                           By default primecount uses all available CPU cores.\n"
+    "      --threads-file=FILE  Read the number of active threads from FILE\n"
+    "                           while computing, e.g.: echo 4 > FILE\n"
+    "      --threads-per-group=NUM\n"
+    "                           Threads per NUMA node or L3 cache domain,\n"
+    "                           used for two-level load balancing.\n"
     "  -v, --version            Print version and license information\n"
     "  -h, --help               Print this help menu\n"
     "\n"
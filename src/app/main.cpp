@@ -28,12 +28,15 @@
 #include <gourdon.hpp>
 #include <imath.hpp>
 #include <int128_t.hpp>
+#include <LeafStats.hpp>
 #include <PhiTiny.hpp>
 #include <print.hpp>
 #include <S.hpp>
 #include <to_string.hpp>
+#include <WarmCache.hpp>
 
 #include <stdint.h>
+#include <cstddef>
 #include <exception>
 #include <iostream>
 #include <limits>
@@ -345,6 +348,187 @@ maxint_t S2_hard(maxint_t x, int threads)
     return S2_hard(x, y, z, c, Li(x), threads);
 }
 
+/// Execute the function corresponding
+/// to the user's main command-line option.
+///
+maxint_t compute(int option,
+                 maxint_t x,
+                 int64_t a,
+                 int64_t q,
+                 int threads)
+{
+  switch (option)
+  {
+    case OPTION_DEFAULT:
+      return pi(x, threads);
+    case OPTION_DELEGLISE_RIVAT:
+      return pi_deleglise_rivat(x, threads);
+    case OPTION_DELEGLISE_RIVAT_64:
+      return pi_deleglise_rivat_64(to_int64(x), threads);
+    case OPTION_GOURDON:
+      return pi_gourdon(x, threads);
+    case OPTION_GOURDON_64:
+      return pi_gourdon_64(to_int64(x), threads);
+    case OPTION_LEGENDRE:
+      return pi_legendre(to_int64(x), threads);
+    case OPTION_LEHMER:
+      return pi_lehmer(to_int64(x), threads);
+    case OPTION_LMO:
+      return pi_lmo_parallel(x, threads);
+    case OPTION_LMO1:
+      return pi_lmo1(to_int64(x));
+    case OPTION_LMO2:
+      return pi_lmo2(to_int64(x));
+    case OPTION_LMO3:
+      return pi_lmo3(to_int64(x));
+    case OPTION_LMO4:
+      return pi_lmo4(to_int64(x));
+    case OPTION_LMO5:
+      return pi_lmo5(to_int64(x));
+    case OPTION_MEISSEL:
+      return pi_meissel(to_int64(x), threads);
+    case OPTION_MERTENS:
+      return mertens(x, threads);
+    case OPTION_PRIMESIEVE:
+      return pi_primesieve(to_int64(x));
+    case OPTION_PRIME_SUM:
+      return prime_sum(x, threads);
+    case OPTION_LI:
+      return Li(x);
+    case OPTION_LIINV:
+      return Li_inverse(x);
+    case OPTION_R:
+      return RiemannR(x);
+    case OPTION_R_INVERSE:
+      return RiemannR_inverse(x);
+    case OPTION_NTHPRIME:
+      return nth_prime(to_int64(x), threads);
+    case OPTION_PHI:
+      return phi(to_int64(x), a, threads);
+    case OPTION_PI_MOD:
+      return pi_lmo_mod(to_int64(x), q, a, threads);
+    case OPTION_P2:
+      return P2(x, threads);
+    case OPTION_S1:
+      return S1(x, threads);
+    case OPTION_S2_EASY:
+      return S2_easy(x, threads);
+    case OPTION_S2_HARD:
+      return S2_hard(x, threads);
+    case OPTION_S2_TRIVIAL:
+      return S2_trivial(x, threads);
+    case OPTION_AC:
+      return AC(x, threads);
+    case OPTION_B:
+      return B(x, threads);
+    case OPTION_D:
+      return D(x, threads);
+    case OPTION_PHI0:
+      return Phi0(x, threads);
+    case OPTION_SIGMA:
+      return Sigma(x, threads);
+    case OPTION_SEMIPRIMES:
+      return semiprime_count(x, threads);
+#ifdef HAVE_INT128_T
+    case OPTION_DELEGLISE_RIVAT_128:
+      return pi_deleglise_rivat_128(x, threads);
+    case OPTION_GOURDON_128:
+      return pi_gourdon_128(x, threads);
+#endif
+  }
+
+  return 0;
+}
+
+/// Remove the last number from the line
+/// and return it (as int64_t).
+///
+int64_t pop_number(std::string& expr, const std::string& errorMsg)
+{
+  std::size_t end = expr.find_last_not_of(" \t\r");
+  std::size_t sep = expr.find_last_of(" \t", end);
+  if (sep == std::string::npos)
+    throw primecount_error(errorMsg);
+  int64_t n = (int64_t) to_maxint(expr.substr(sep + 1, end - sep));
+  expr = expr.substr(0, sep);
+  return n;
+}
+
+/// Server mode (--server, --stdin): read one x number (or integer
+/// arithmetic expression) per line from stdin and print the result
+/// of the selected main option as soon as it has been computed.
+/// For --phi each line must contain 2 numbers: X A and for
+/// --pi-mod each line must contain 3 numbers: X Q A.
+/// Empty lines and lines starting with # are ignored.
+/// The PiTable, the primes and the sieve buffers are kept
+/// in memory across lines (see WarmCache.hpp).
+///
+int server(const CmdOptions& opts)
+{
+  int exitCode = 0;
+  std::string line;
+  set_warm_cache(true);
+
+  while (std::getline(std::cin, line))
+  {
+    // Skip empty lines and comments
+    std::size_t pos = line.find_first_not_of(" \t\r");
+    if (pos == std::string::npos || line[pos] == '#')
+      continue;
+
+    try
+    {
+      double time = get_time();
+      std::string expr = line.substr(pos);
+      int64_t a = opts.a;
+      int64_t q = opts.q;
+
+      if (opts.option == OPTION_PHI)
+      {
+        // Line format: X A
+        a = pop_number(expr, "option --phi requires 2 numbers");
+      }
+
+      if (opts.option == OPTION_PI_MOD)
+      {
+        // Line format: X Q A
+        a = pop_number(expr, "option --pi-mod requires 3 numbers");
+        q = pop_number(expr, "option --pi-mod requires 3 numbers");
+      }
+
+      maxint_t x = to_maxint(expr);
+      int threads = get_num_threads();
+      maxint_t res = compute(opts.option, x, a, q, threads);
+
+      if (is_print_combined_result())
+      {
+        // Add empty line after last partial formula
+        if (is_print())
+          std::cout << std::endl;
+
+        // std::endl flushes the result, this way
+        // the caller can process it immediately.
+        std::cout << res << std::endl;
+
+        if (opts.time)
+          print_seconds(get_time() - time);
+      }
+    }
+    catch (std::exception& e)
+    {
+      // In server mode an invalid line must
+      // not stop processing the following lines.
+      std::cerr << "primecount: " << e.what() << std::endl;
+      exitCode = 1;
+    }
+  }
+
+  if (!opts.leafStatsFile.empty())
+    write_leaf_stats(opts.leafStatsFile);
+
+  return exitCode;
+}
+
 } // namespace
 
 int main (int argc, char* argv[])
@@ -352,84 +536,13 @@ int main (int argc, char* argv[])
   try
   {
     CmdOptions opts = parseOptions(argc, argv);
-    double time = get_time();
 
-    auto x = opts.x;
-    auto a = opts.a;
-    auto threads = get_num_threads();
-    maxint_t res = 0;
+    if (opts.server)
+      return server(opts);
 
-    switch (opts.option)
-    {
-      case OPTION_DEFAULT:
-        res = pi(x, threads); break;
-      case OPTION_DELEGLISE_RIVAT:
-        res = pi_deleglise_rivat(x, threads); break;
-      case OPTION_DELEGLISE_RIVAT_64:
-        res = pi_deleglise_rivat_64(to_int64(x), threads); break;
-      case OPTION_GOURDON:
-        res = pi_gourdon(x, threads); break;
-      case OPTION_GOURDON_64:
-        res = pi_gourdon_64(to_int64(x), threads); break;
-      case OPTION_LEGENDRE:
-        res = pi_legendre(to_int64(x), threads); break;
-      case OPTION_LEHMER:
-        res = pi_lehmer(to_int64(x), threads); break;
-      case OPTION_LMO:
-        res = pi_lmo_parallel(to_int64(x), threads); break;
-      case OPTION_LMO1:
-        res = pi_lmo1(to_int64(x)); break;
-      case OPTION_LMO2:
-        res = pi_lmo2(to_int64(x)); break;
-      case OPTION_LMO3:
-        res = pi_lmo3(to_int64(x)); break;
-      case OPTION_LMO4:
-        res = pi_lmo4(to_int64(x)); break;
-      case OPTION_LMO5:
-        res = pi_lmo5(to_int64(x)); break;
-      case OPTION_MEISSEL:
-        res = pi_meissel(to_int64(x), threads); break;
-      case OPTION_PRIMESIEVE:
-        res = pi_primesieve(to_int64(x)); break;
-      case OPTION_LI:
-        res = Li(x); break;
-      case OPTION_LIINV:
-        res = Li_inverse(x); break;
-      case OPTION_R:
-        res = RiemannR(x); break;
-      case OPTION_R_INVERSE:
-        res = RiemannR_inverse(x); break;
-      case OPTION_NTHPRIME:
-        res = nth_prime(to_int64(x), threads); break;
-      case OPTION_PHI:
-        res = phi(to_int64(x), a, threads); break;
-      case OPTION_P2:
-        res = P2(x, threads); break;
-      case OPTION_S1:
-        res = S1(x, threads); break;
-      case OPTION_S2_EASY:
-        res = S2_easy(x, threads); break;
-      case OPTION_S2_HARD:
-        res = S2_hard(x, threads); break;
-      case OPTION_S2_TRIVIAL:
-        res = S2_trivial(x, threads); break;
-      case OPTION_AC:
-        res = AC(x, threads); break;
-      case OPTION_B:
-        res = B(x, threads); break;
-      case OPTION_D:
-        res = D(x, threads); break;
-      case OPTION_PHI0:
-        res = Phi0(x, threads); break;
-      case OPTION_SIGMA:
-        res = Sigma(x, threads); break;
-#ifdef HAVE_INT128_T
-      case OPTION_DELEGLISE_RIVAT_128:
-        res = pi_deleglise_rivat_128(x, threads); break;
-      case OPTION_GOURDON_128:
-        res = pi_gourdon_128(x, threads); break;
-#endif
-    }
+    double time = get_time();
+    int threads = get_num_threads();
+    maxint_t res = compute(opts.option, opts.x, opts.a, opts.q, threads);
 
     if (is_print_combined_result())
     {
@@ -442,6 +555,9 @@ int main (int argc, char* argv[])
       if (opts.time)
         print_seconds(get_time() - time);
     }
+
+    if (!opts.leafStatsFile.empty())
+      write_leaf_stats(opts.leafStatsFile);
   }
   catch (std::exception& e)
   {
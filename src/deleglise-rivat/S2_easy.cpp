@@ -9,22 +9,25 @@
 ///        method, Revista do DETUA, vol. 4, no. 6, March 2006,
 ///        pp. 759-768.
 ///
-/// Copyright (C) 2021 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
 ///
 
 #include <PiTable.hpp>
+#include <pi_sum.hpp>
 #include <primecount-internal.hpp>
 #include <fast_div.hpp>
 #include <generate.hpp>
 #include <int128_t.hpp>
 #include <min.hpp>
+#include <parallel.hpp>
 #include <imath.hpp>
 #include <print.hpp>
 #include <RelaxedAtomic.hpp>
 #include <StatusS2.hpp>
+#include <LeafStats.hpp>
 #include <S.hpp>
 
 #include <stdint.h>
@@ -57,60 +60,66 @@ T S2_easy_OpenMP(T x,
   threads = std::min(threads, max_threads);
   threads = ideal_num_threads(x13, threads, thread_threshold);
 
-  StatusS2 status(x);
+  StatusS2 status(x, is_print);
   PiTable pi(y, threads);
   int64_t pi_sqrty = pi[isqrt(y)];
   int64_t pi_x13 = pi[x13];
   RelaxedAtomic<int64_t> min_b(max(c, pi_sqrty) + 1);
 
   // for (b = pi[sqrty] + 1; b <= pi_x13; b++)
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
-  for (int64_t b = min_b++; b <= pi_x13; b = min_b++)
+  sum += parallel_sum<T>(threads, [&](int thread_num)
   {
-    int64_t prime = primes[b];
-    T xp = x / prime;
-    int64_t min_trivial = min(xp / prime, y);
-    int64_t min_clustered = (int64_t) isqrt(xp);
-    int64_t min_sparse = z / prime;
-
-    min_clustered = in_between(prime, min_clustered, y);
-    min_sparse = in_between(prime, min_sparse, y);
-
-    int64_t l = pi[min_trivial];
-    int64_t pi_min_clustered = pi[min_clustered];
-    int64_t pi_min_sparse = pi[min_sparse];
-
-    // Find all clustered easy leaves where
-    // successive leaves are identical.
-    // pq = primes[b] * primes[l]
-    // Which satisfy: pq > z && x / pq <= y
-    // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
-    while (l > pi_min_clustered)
-    {
-      int64_t xpq = fast_div64(xp, primes[l]);
-      int64_t pi_xpq = pi[xpq];
-      int64_t phi_xpq = pi_xpq - b + 2;
-      int64_t xpq2 = fast_div64(xp, primes[pi_xpq + 1]);
-      int64_t lmin = pi[xpq2];
-      sum += phi_xpq * (l - lmin);
-      l = lmin;
-    }
+    T thread_sum = 0;
 
-    // Find all sparse easy leaves where
-    // successive leaves are different.
-    // pq = primes[b] * primes[l]
-    // Which satisfy: pq > z && x / pq <= y
-    // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
-    for (; l > pi_min_sparse; l--)
+    for (int64_t b = min_b++; b <= pi_x13; b = min_b++)
     {
-      int64_t xpq = fast_div64(xp, primes[l]);
-      sum += pi[xpq] - b + 2;
+      LEAF_STATS(thread_leaf_stats().low = 0);
+      int64_t prime = primes[b];
+      T xp = x / prime;
+      int64_t min_trivial = min(xp / prime, y);
+      int64_t min_clustered = (int64_t) isqrt(xp);
+      int64_t min_sparse = z / prime;
+
+      min_clustered = in_between(prime, min_clustered, y);
+      min_sparse = in_between(prime, min_sparse, y);
+
+      int64_t l = pi[min_trivial];
+      int64_t pi_min_clustered = pi[min_clustered];
+      int64_t pi_min_sparse = pi[min_sparse];
+
+      // Find all clustered easy leaves where
+      // successive leaves are identical.
+      // pq = primes[b] * primes[l]
+      // Which satisfy: pq > z && x / pq <= y
+      // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
+      while (l > pi_min_clustered)
+      {
+        int64_t xpq = fast_div64(xp, primes[l]);
+        int64_t pi_xpq = pi[xpq];
+        int64_t phi_xpq = pi_xpq - b + 2;
+        int64_t xpq2 = fast_div64(xp, primes[pi_xpq + 1]);
+        int64_t lmin = pi[xpq2];
+        thread_sum += phi_xpq * (l - lmin);
+        LEAF_STATS(thread_leaf_stats().add_clustered_leaves(LEAF_S2_EASY, b, l - lmin));
+        l = lmin;
+      }
+
+      // Find all sparse easy leaves where
+      // successive leaves are different.
+      // pq = primes[b] * primes[l]
+      // Which satisfy: pq > z && x / pq <= y
+      // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
+      int64_t sparse_leaves = max(l, pi_min_sparse) - pi_min_sparse;
+      LEAF_STATS(thread_leaf_stats().add_sparse_leaves(LEAF_S2_EASY, b, sparse_leaves));
+      thread_sum += pi_sum<T>(pi, pi_min_sparse + 1, l + 1, [&](uint64_t i) { return fast_div64(xp, primes[i]); });
+      thread_sum -= (T) sparse_leaves * (b - 2);
+
+      if (is_print && thread_num == 0)
+        status.print(b, pi_x13);
     }
 
-    #pragma omp master
-    if (is_print)
-      status.print(b, pi_x13);
-  }
+    return thread_sum;
+  });
 
   return sum;
 }
@@ -136,7 +145,7 @@ int64_t S2_easy(int64_t x,
     time = get_time();
   }
 
-  auto primes = generate_primes<uint32_t>(y);
+  auto primes = generate_primes<uint32_t>(y, threads);
   int64_t sum = S2_easy_OpenMP((uint64_t) x, y, z, c, primes, threads, is_print);
 
   if (is_print)
@@ -169,12 +178,12 @@ int128_t S2_easy(int128_t x,
   // uses less memory
   if (y <= numeric_limits<uint32_t>::max())
   {
-    auto primes = generate_primes<uint32_t>(y);
+    auto primes = generate_primes<uint32_t>(y, threads);
     sum = S2_easy_OpenMP((uint128_t) x, y, z, c, primes, threads, is_print);
   }
   else
   {
-    auto primes = generate_primes<int64_t>(y);
+    auto primes = generate_primes<int64_t>(y, threads);
     sum = S2_easy_OpenMP((uint128_t) x, y, z, c, primes, threads, is_print);
   }
 
@@ -13,23 +13,26 @@
 ///        method, Revista do DETUA, vol. 4, no. 6, March 2006,
 ///        pp. 759-768.
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
 ///
 
 #include <PiTable.hpp>
+#include <pi_sum.hpp>
 #include <primecount-internal.hpp>
 #include <fast_div.hpp>
 #include <generate.hpp>
 #include <int128_t.hpp>
 #include <min.hpp>
+#include <parallel.hpp>
 #include <imath.hpp>
 #include <Vector.hpp>
 #include <print.hpp>
 #include <RelaxedAtomic.hpp>
 #include <StatusS2.hpp>
+#include <LeafStats.hpp>
 #include <S.hpp>
 
 #include <libdivide.h>
@@ -76,6 +79,7 @@ T S2_easy_64(T xp128,
     uint64_t xpq2 = xp / primes[pi_xpq + 1];
     uint64_t lmin = pi[xpq2];
     sum += phi_xpq * (l - lmin);
+    LEAF_STATS(thread_leaf_stats().add_clustered_leaves(LEAF_S2_EASY, b, l - lmin));
     l = lmin;
   }
 
@@ -84,11 +88,10 @@ T S2_easy_64(T xp128,
   // pq = primes[b] * primes[l]
   // Which satisfy: pq > z && x / pq <= y
   // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
-  for (; l > pi_min_sparse; l--)
-  {
-    uint64_t xpq = xp / primes[l];
-    sum += pi[xpq] - b + 2;
-  }
+  uint64_t sparse_leaves = max(l, pi_min_sparse) - pi_min_sparse;
+  LEAF_STATS(thread_leaf_stats().add_sparse_leaves(LEAF_S2_EASY, b, sparse_leaves));
+  sum += pi_sum<T>(pi, pi_min_sparse + 1, l + 1, [&](uint64_t i) { return xp / primes[i]; });
+  sum -= (T) sparse_leaves * (b - 2);
 
   return sum;
 }
@@ -127,6 +130,7 @@ T S2_easy_128(T xp,
     uint64_t xpq2 = fast_div64(xp, primes[b + phi_xpq - 1]);
     uint64_t lmin = pi[xpq2];
     sum += phi_xpq * (l - lmin);
+    LEAF_STATS(thread_leaf_stats().add_clustered_leaves(LEAF_S2_EASY, b, l - lmin));
     l = lmin;
   }
 
@@ -135,11 +139,10 @@ T S2_easy_128(T xp,
   // pq = primes[b] * primes[l]
   // Which satisfy: pq > z && x / pq <= y
   // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
-  for (; l > pi_min_sparse; l--)
-  {
-    uint64_t xpq = fast_div64(xp, primes[l]);
-    sum += pi[xpq] - b + 2;
-  }
+  uint64_t sparse_leaves = max(l, pi_min_sparse) - pi_min_sparse;
+  LEAF_STATS(thread_leaf_stats().add_sparse_leaves(LEAF_S2_EASY, b, sparse_leaves));
+  sum += pi_sum<T>(pi, pi_min_sparse + 1, l + 1, [&](uint64_t i) { return fast_div64(xp, primes[i]); });
+  sum -= (T) sparse_leaves * (b - 2);
 
   return sum;
 }
@@ -173,28 +176,34 @@ T S2_easy_OpenMP(T x,
   threads = std::min(threads, max_threads);
   threads = ideal_num_threads(x13, threads, thread_threshold);
 
-  StatusS2 status(x);
+  StatusS2 status(x, is_print);
   PiTable pi(y, threads);
   int64_t pi_sqrty = pi[isqrt(y)];
   int64_t pi_x13 = pi[x13];
   RelaxedAtomic<int64_t> min_b(max(c, pi_sqrty) + 1);
 
   // for (b = pi[sqrty] + 1; b <= pi_x13; b++)
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
-  for (int64_t b = min_b++; b <= pi_x13; b = min_b++)
+  sum += parallel_sum<T>(threads, [&](int thread_num)
   {
-    int64_t prime = primes[b];
-    T xp = x / prime;
+    T thread_sum = 0;
 
-    if (xp <= numeric_limits<uint64_t>::max())
-      sum += S2_easy_64(xp, y, z, b, prime, lprimes, pi);
-    else
-      sum += S2_easy_128(xp, y, z, b, prime, primes, pi);
+    for (int64_t b = min_b++; b <= pi_x13; b = min_b++)
+    {
+      LEAF_STATS(thread_leaf_stats().low = 0);
+      int64_t prime = primes[b];
+      T xp = x / prime;
 
-    #pragma omp master
-    if (is_print)
-      status.print(b, pi_x13);
-  }
+      if (xp <= numeric_limits<uint64_t>::max())
+        thread_sum += S2_easy_64(xp, y, z, b, prime, lprimes, pi);
+      else
+        thread_sum += S2_easy_128(xp, y, z, b, prime, primes, pi);
+
+      if (is_print && thread_num == 0)
+        status.print(b, pi_x13);
+    }
+
+    return thread_sum;
+  });
 
   return sum;
 }
@@ -220,7 +229,7 @@ int64_t S2_easy(int64_t x,
     time = get_time();
   }
 
-  auto primes = generate_primes<uint32_t>(y);
+  auto primes = generate_primes<uint32_t>(y, threads);
   int64_t sum = S2_easy_OpenMP((uint64_t) x, y, z, c, primes, threads, is_print);
 
   if (is_print)
@@ -253,12 +262,12 @@ int128_t S2_easy(int128_t x,
   // uses less memory
   if (y <= numeric_limits<uint32_t>::max())
   {
-    auto primes = generate_primes<uint32_t>(y);
+    auto primes = generate_primes<uint32_t>(y, threads);
     sum = S2_easy_OpenMP((uint128_t) x, y, z, c, primes, threads, is_print);
   }
   else
   {
-    auto primes = generate_primes<int64_t>(y);
+    auto primes = generate_primes<int64_t>(y, threads);
     sum = S2_easy_OpenMP((uint128_t) x, y, z, c, primes, threads, is_print);
   }
 
@@ -18,7 +18,7 @@
 ///        method, Revista do DETUA, vol. 4, no. 6, March 2006,
 ///        pp. 759-768.
 ///
-/// Copyright (C) 2021 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -28,6 +28,7 @@
 #include <PiTable.hpp>
 #include <FactorTable.hpp>
 #include <Sieve.hpp>
+#include <LeafStats.hpp>
 #include <fast_div.hpp>
 #include <generate.hpp>
 #include <generate_phi.hpp>
@@ -35,6 +36,7 @@
 #include <int128_t.hpp>
 #include <LoadBalancerS2.hpp>
 #include <min.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
 #include <S.hpp>
 
@@ -85,14 +87,22 @@ T S2_hard_thread(T x,
 
   auto phi = generate_phi(low, max_b, primes, pi);
   Sieve sieve(low, segment_size, max_b);
+  sieve.add_primes(primes, max_b);
+  LEAF_STATS(LeafStats& stats = thread_leaf_stats());
   thread.init_finished();
 
   // Segmented sieve of Eratosthenes
   for (; low < limit; low += segment_size)
   {
+    // Stop if the backup copy of this
+    // work unit has already finished.
+    if (thread.is_cancelled())
+      break;
+
     // current segment [low, high[
     int64_t high = min(low + segment_size, limit);
     low1 = max(low, 1);
+    LEAF_STATS(stats.low = low);
 
     // For b < min_b there are no special leaves:
     // low <= x / (primes[b] * m) < high
@@ -122,6 +132,7 @@ T S2_hard_thread(T x,
         // mu(m) != 0 && prime < lpf(m)
         if (prime < factor.mu_lpf(m))
         {
+          LEAF_STATS(stats.add_leaves(LEAF_S2_HARD, b, 1));
           int64_t xpm = fast_div64(xp, factor.to_number(m));
           int64_t stop = xpm - low;
           int64_t phi_xpm = phi[b] + sieve.count(stop);
@@ -156,6 +167,7 @@ T S2_hard_thread(T x,
         int64_t stop = xpq - low;
         int64_t phi_xpq = phi[b] + sieve.count(stop);
         sum += phi_xpq;
+        LEAF_STATS(stats.add_leaves(LEAF_S2_HARD, b, 1));
       }
 
       phi[b] += sieve.get_total_count();
@@ -208,7 +220,7 @@ T S2_hard_OpenMP(T x,
   int64_t max_prime = min(y, z / isqrt(y));
   PiTable pi(max_prime, threads);
 
-  #pragma omp parallel num_threads(threads)
+  parallel(threads, [&](int)
   {
     ThreadData thread;
 
@@ -223,7 +235,7 @@ T S2_hard_OpenMP(T x,
       thread.sum = (T) sum;
       thread.stop_time();
     }
-  }
+  });
 
   T sum = (T) loadBalancer.get_sum();
 
@@ -254,7 +266,7 @@ int64_t S2_hard(int64_t x,
 
   FactorTable<uint16_t> factor(y, threads);
   int64_t max_prime = min(y, z / isqrt(y));
-  auto primes = generate_primes<int32_t>(max_prime);
+  auto primes = generate_primes<int32_t>(max_prime, threads);
   int64_t sum = S2_hard_OpenMP(x, y, z, c, s2_hard_approx, primes, factor, threads, is_print);
 
   if (is_print)
@@ -290,14 +302,14 @@ int128_t S2_hard(int128_t x,
   {
     FactorTable<uint16_t> factor(y, threads);
     int64_t max_prime = min(y, z / isqrt(y));
-    auto primes = generate_primes<uint32_t>(max_prime);
+    auto primes = generate_primes<uint32_t>(max_prime, threads);
     sum = S2_hard_OpenMP(x, y, z, c, s2_hard_approx, primes, factor, threads, is_print);
   }
   else
   {
     FactorTable<uint32_t> factor(y, threads);
     int64_t max_prime = min(y, z / isqrt(y));
-    auto primes = generate_primes<int64_t>(max_prime);
+    auto primes = generate_primes<int64_t>(max_prime, threads);
     sum = S2_hard_OpenMP(x, y, z, c, s2_hard_approx, primes, factor, threads, is_print);
   }
 
@@ -32,19 +32,24 @@
 ///
 
 #include <PiTable.hpp>
+#include <pi_sum.hpp>
 #include <SegmentedPiTable.hpp>
 #include <primecount-internal.hpp>
 #include <LoadBalancerAC.hpp>
+#include <LeafStats.hpp>
 #include <fast_div.hpp>
 #include <generate.hpp>
 #include <gourdon.hpp>
 #include <int128_t.hpp>
 #include <libdivide.h>
 #include <min.hpp>
+#include <parallel.hpp>
 #include <imath.hpp>
 #include <Vector.hpp>
 #include <print.hpp>
 #include <RelaxedAtomic.hpp>
+#include <SegmentedPrimes.hpp>
+#include <WarmCache.hpp>
 
 #include <stdint.h>
 
@@ -77,22 +82,16 @@ T A_64(T xlow,
   uint64_t i = pi[max(prime, min_2nd_prime)] + 1;
   uint64_t max_i1 = pi[min(xp / y, max_2nd_prime)];
   uint64_t max_i2 = pi[max_2nd_prime];
+  LEAF_STATS(thread_leaf_stats().add_leaves(LEAF_A, pi[prime], max(i, max_i2 + 1) - i));
 
   // pq = primes[b] * primes[i]
   // x / pq >= y && low <= x / pq < high
-  for (; i <= max_i1; i++)
-  {
-    uint64_t xpq = xp / primes[i];
-    sum += segmentedPi[xpq];
-  }
+  sum += pi_sum<T>(segmentedPi, i, max_i1 + 1, [&](uint64_t j) { return xp / primes[j]; });
+  i = max(i, max_i1 + 1);
 
   // pq = primes[b] * primes[i]
   // x / pq < y && low <= x / pq < high
-  for (; i <= max_i2; i++)
-  {
-    uint64_t xpq = xp / primes[i];
-    sum += segmentedPi[xpq] * 2;
-  }
+  sum += pi_sum<T>(segmentedPi, i, max_i2 + 1, [&](uint64_t j) { return xp / primes[j]; }) * 2;
 
   return sum;
 }
@@ -121,22 +120,16 @@ T A_128(T xlow,
   uint64_t i = pi[max(prime, min_2nd_prime)] + 1;
   uint64_t max_i1 = pi[min(xp / y, max_2nd_prime)];
   uint64_t max_i2 = pi[max_2nd_prime];
+  LEAF_STATS(thread_leaf_stats().add_leaves(LEAF_A, pi[prime], max(i, max_i2 + 1) - i));
 
   // pq = primes[b] * primes[i]
   // x / pq >= y && low <= x / pq < high
-  for (; i <= max_i1; i++)
-  {
-    uint64_t xpq = fast_div64(xp, primes[i]);
-    sum += segmentedPi[xpq];
-  }
+  sum += pi_sum<T>(segmentedPi, i, max_i1 + 1, [&](uint64_t j) { return fast_div64(xp, primes[j]); });
+  i = max(i, max_i1 + 1);
 
   // pq = primes[b] * primes[i]
   // x / pq < y && low <= x / pq < high
-  for (; i <= max_i2; i++)
-  {
-    uint64_t xpq = fast_div64(xp, primes[i]);
-    sum += segmentedPi[xpq] * 2;
-  }
+  sum += pi_sum<T>(segmentedPi, i, max_i2 + 1, [&](uint64_t j) { return fast_div64(xp, primes[j]); }) * 2;
 
   return sum;
 }
@@ -177,6 +170,7 @@ T C1(T xp,
     uint64_t m64 = (uint64_t) m128;
 
     if (m64 > min_m) {
+      LEAF_STATS(thread_leaf_stats().add_leaves(LEAF_C, b, 1));
       uint64_t xpm = fast_div64(xp, m64);
       T phi_xpm = pi[xpm] - b + 2;
       sum += phi_xpm * MU;
@@ -229,6 +223,7 @@ T C2_64(T xlow,
     uint64_t xpq2 = xp / primes[pi_xpq + 1];
     uint64_t imin = pi[max(xpq2, min_clustered)];
     sum += phi_xpq * (i - imin);
+    LEAF_STATS(thread_leaf_stats().add_clustered_leaves(LEAF_C, b, i - imin));
     i = imin;
   }
 
@@ -237,11 +232,10 @@ T C2_64(T xlow,
   // pq = primes[b] * primes[i]
   // Which satisfy: low <= x / pq < high && q <= y && pq > z
   // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
-  for (; i > pi_min_m; i--)
-  {
-    uint64_t xpq = xp / primes[i];
-    sum += segmentedPi[xpq] - b + 2;
-  }
+  uint64_t sparse_leaves = max(i, pi_min_m) - pi_min_m;
+  LEAF_STATS(thread_leaf_stats().add_sparse_leaves(LEAF_C, b, sparse_leaves));
+  sum += pi_sum<T>(segmentedPi, pi_min_m + 1, i + 1, [&](uint64_t j) { return xp / primes[j]; });
+  sum -= (T) sparse_leaves * (b - 2);
 
   return sum;
 }
@@ -287,6 +281,7 @@ T C2_128(T xlow,
     uint64_t xpq2 = fast_div64(xp, primes[pi_xpq + 1]);
     uint64_t imin = pi[max(xpq2, min_clustered)];
     sum += phi_xpq * (i - imin);
+    LEAF_STATS(thread_leaf_stats().add_clustered_leaves(LEAF_C, b, i - imin));
     i = imin;
   }
 
@@ -295,11 +290,10 @@ T C2_128(T xlow,
   // pq = primes[b] * primes[i]
   // Which satisfy: low <= x / pq < high && q <= y && pq > z
   // where phi(x / pq, b - 1) = pi(x / pq) - b + 2
-  for (; i > pi_min_m; i--)
-  {
-    uint64_t xpq = fast_div64(xp, primes[i]);
-    sum += segmentedPi[xpq] - b + 2;
-  }
+  uint64_t sparse_leaves = max(i, pi_min_m) - pi_min_m;
+  LEAF_STATS(thread_leaf_stats().add_sparse_leaves(LEAF_C, b, sparse_leaves));
+  sum += pi_sum<T>(segmentedPi, pi_min_m + 1, i + 1, [&](uint64_t j) { return fast_div64(xp, primes[j]); });
+  sum -= (T) sparse_leaves * (b - 2);
 
   return sum;
 }
@@ -341,7 +335,8 @@ T AC_OpenMP(T x,
   // PiTable is accessed much less frequently than
   // SegmentedPiTable, hence it is OK that PiTable's size
   // is fairly large and does not fit into the CPU's cache.
-  PiTable pi(max(z, max_a_prime), threads);
+  auto pi_table = get_pi_table(max(z, max_a_prime), threads);
+  const PiTable& pi = *pi_table;
 
   int64_t pi_y = pi[y];
   int64_t pi_sqrtz = pi[isqrt(z)];
@@ -357,7 +352,7 @@ T AC_OpenMP(T x,
   // 2) Computation of the C2 formula.
   // 3) Computation of the A formula.
   //
-  #pragma omp parallel num_threads(threads) reduction(+: sum)
+  sum += parallel_sum<T>(threads, [&](int)
   {
     // SegmentedPiTable is accessed very frequently.
     // In order to get good performance it is important that
@@ -365,11 +360,14 @@ T AC_OpenMP(T x,
     // Hence we use a small segment_size of x^(1/4).
     SegmentedPiTable segmentedPi;
     int64_t low, high;
+    T thread_sum = 0;
 
     // C1 formula: pi[(x/z)^(1/3)] < b <= pi[pi_sqrtz]
     // There are very few iterations in this loop,
     // hence the use of an atomic loop counter (min_c1)
     // won't cause any scaling issues.
+    LEAF_STATS(thread_leaf_stats().low = 0);
+
     for (int64_t b = min_c1++; b <= pi_sqrtz; b = min_c1++)
     {
       int64_t prime = primes[b];
@@ -378,7 +376,7 @@ T AC_OpenMP(T x,
       T min_m128 = max(xp / (prime * prime), z / prime);
       int64_t min_m = min(min_m128, max_m);
 
-      sum -= C1<-1>(xp, b, b, pi_y, 1, min_m, max_m, primes, pi);
+      thread_sum -= C1<-1>(xp, b, b, pi_y, 1, min_m, max_m, primes, pi);
     }
 
     // for (low = 0; low < sqrt; low += segment_size)
@@ -386,6 +384,7 @@ T AC_OpenMP(T x,
     {
       // Current segment [low, high[
       segmentedPi.init(low, high);
+      LEAF_STATS(thread_leaf_stats().low = low);
       T xlow = x / max(low, 1);
       T xhigh = x / high;
 
@@ -413,9 +412,9 @@ T AC_OpenMP(T x,
         T xp = x / prime;
 
         if (xp <= numeric_limits<uint64_t>::max())
-          sum += C2_64(xlow, xhigh, (uint64_t) xp, y, b, prime, lprimes, pi, segmentedPi);
+          thread_sum += C2_64(xlow, xhigh, (uint64_t) xp, y, b, prime, lprimes, pi, segmentedPi);
         else
-          sum += C2_128(xlow, xhigh, xp, y, b, primes, pi, segmentedPi);
+          thread_sum += C2_128(xlow, xhigh, xp, y, b, primes, pi, segmentedPi);
       }
 
       // A formula: pi[x_star] < b <= pi[x13]
@@ -425,12 +424,14 @@ T AC_OpenMP(T x,
         T xp = x / prime;
 
         if (xp <= numeric_limits<uint64_t>::max())
-          sum += A_64(xlow, xhigh, (uint64_t) xp, y, prime, lprimes, pi, segmentedPi);
+          thread_sum += A_64(xlow, xhigh, (uint64_t) xp, y, prime, lprimes, pi, segmentedPi);
         else
-          sum += A_128(xlow, xhigh, xp, y, prime, primes, pi, segmentedPi);
+          thread_sum += A_128(xlow, xhigh, xp, y, prime, primes, pi, segmentedPi);
       }
     }
-  }
+
+    return thread_sum;
+  });
 
   return sum;
 }
@@ -460,9 +461,9 @@ int64_t AC(int64_t x,
   int64_t max_c_prime = y;
   int64_t max_a_prime = (int64_t) isqrt(x / x_star);
   int64_t max_prime = max(max_a_prime, max_c_prime);
-  auto primes = generate_primes<uint32_t>(max_prime);
+  auto primes = get_primes<uint32_t>(max_prime, threads);
 
-  int64_t sum = AC_OpenMP((uint64_t) x, y, z, k, x_star, max_a_prime, primes, threads, is_print);
+  int64_t sum = AC_OpenMP((uint64_t) x, y, z, k, x_star, max_a_prime, *primes, threads, is_print);
 
   if (is_print)
     print("A + C", sum, time);
@@ -498,12 +499,12 @@ int128_t AC(int128_t x,
   // uses less memory
   if (max_prime <= numeric_limits<uint32_t>::max())
   {
-    auto primes = generate_primes<uint32_t>(max_prime);
-    sum = AC_OpenMP((uint128_t) x, y, z, k, x_star, max_a_prime, primes, threads, is_print);
+    auto primes = get_primes<uint32_t>(max_prime, threads);
+    sum = AC_OpenMP((uint128_t) x, y, z, k, x_star, max_a_prime, *primes, threads, is_print);
   }
   else
   {
-    auto primes = generate_primes<uint64_t>(max_prime);
+    SegmentedPrimes<uint64_t> primes(max_prime, threads);
     sum = AC_OpenMP((uint128_t) x, y, z, k, x_star, max_a_prime, primes, threads, is_print);
   }
 
@@ -23,6 +23,7 @@
 #include <LoadBalancerP2.hpp>
 #include <macros.hpp>
 #include <min.hpp>
+#include <parallel.hpp>
 #include <imath.hpp>
 #include <print.hpp>
 
@@ -99,12 +100,14 @@ T B_OpenMP(T x,
   threads = loadBalancer.get_threads();
 
   // for (low = sqrt(x); low < x / y; low += dist)
-  #pragma omp parallel num_threads(threads) reduction(+:sum)
+  sum += parallel_sum<T>(threads, [&](int)
   {
+    T thread_sum = 0;
     int64_t low, high;
     while (loadBalancer.get_work(low, high))
-      sum += B_thread(x, y, low, high);
-  }
+      thread_sum += B_thread(x, y, low, high);
+    return thread_sum;
+  });
 
   return sum;
 }
@@ -15,7 +15,7 @@
 ///        compressed lookup table of moebius function values,
 ///        least prime factors and max prime factors.
 ///
-/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -25,6 +25,7 @@
 #include <FactorTableD.hpp>
 #include <PiTable.hpp>
 #include <Sieve.hpp>
+#include <LeafStats.hpp>
 #include <LoadBalancerS2.hpp>
 #include <fast_div.hpp>
 #include <generate.hpp>
@@ -33,9 +34,13 @@
 #include <imath.hpp>
 #include <int128_t.hpp>
 #include <min.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
+#include <SegmentedPrimes.hpp>
+#include <WarmCache.hpp>
 
 #include <stdint.h>
+#include <limits>
 
 using namespace primecount;
 
@@ -74,14 +79,22 @@ T D_thread(T x,
 
   auto phi = generate_phi(low, max_b, primes, pi);
   Sieve sieve(low, segment_size, max_b);
+  sieve.add_primes(primes, max_b);
+  LEAF_STATS(LeafStats& stats = thread_leaf_stats());
   thread.init_finished();
 
   // Segmented sieve of Eratosthenes
   for (; low < limit; low += segment_size)
   {
+    // Stop if the backup copy of this
+    // work unit has already finished.
+    if (thread.is_cancelled())
+      break;
+
     // current segment [low, high[
     int64_t high = min(low + segment_size, limit);
     low1 = max(low, 1);
+    LEAF_STATS(stats.low = low);
 
     // For b < min_b there are no special leaves:
     // low <= x / (primes[b] * m) < high
@@ -114,6 +127,7 @@ T D_thread(T x,
         // mpf[m] <= y
         if (prime < factor.is_leaf(m))
         {
+          LEAF_STATS(stats.add_leaves(LEAF_D, b, 1));
           int64_t xpm = fast_div64(xp, factor.to_number(m));
           int64_t stop = xpm - low;
           int64_t phi_xpm = phi[b] + sieve.count(stop);
@@ -149,6 +163,7 @@ T D_thread(T x,
         int64_t stop = xpq - low;
         int64_t phi_xpq = phi[b] + sieve.count(stop);
         sum += phi_xpq;
+        LEAF_STATS(stats.add_leaves(LEAF_D, b, 1));
       }
 
       phi[b] += sieve.get_total_count();
@@ -200,9 +215,10 @@ T D_OpenMP(T x,
   threads = std::min(threads, max_threads);
   threads = ideal_num_threads(xz, threads, thread_threshold);
   LoadBalancerS2 loadBalancer(x, xz, d_approx, threads, is_print);
-  PiTable pi(y, threads);
+  auto pi_table = get_pi_table(y, threads);
+  const PiTable& pi = *pi_table;
 
-  #pragma omp parallel num_threads(threads)
+  parallel(threads, [&](int)
   {
     ThreadData thread;
 
@@ -217,7 +233,7 @@ T D_OpenMP(T x,
       thread.sum = (T) sum;
       thread.stop_time();
     }
-  }
+  });
 
   T sum = (T) loadBalancer.get_sum();
 
@@ -247,8 +263,8 @@ int64_t D(int64_t x,
   }
 
   FactorTableD<uint16_t> factor(y, z, threads);
-  auto primes = generate_primes<int32_t>(y);
-  int64_t sum = D_OpenMP(x, y, z, k, d_approx, primes, factor, threads, is_print);
+  auto primes = get_primes<int32_t>(y, threads);
+  int64_t sum = D_OpenMP(x, y, z, k, d_approx, *primes, factor, threads, is_print);
 
   if (is_print)
     print("D", sum, time);
@@ -282,13 +298,19 @@ int128_t D(int128_t x,
   if (z <= FactorTableD<uint16_t>::max())
   {
     FactorTableD<uint16_t> factor(y, z, threads);
-    auto primes = generate_primes<uint32_t>(y);
-    sum = D_OpenMP(x, y, z, k, d_approx, primes, factor, threads, is_print);
+    auto primes = get_primes<uint32_t>(y, threads);
+    sum = D_OpenMP(x, y, z, k, d_approx, *primes, factor, threads, is_print);
+  }
+  else if (y <= std::numeric_limits<uint32_t>::max())
+  {
+    FactorTableD<uint32_t> factor(y, z, threads);
+    auto primes = get_primes<uint32_t>(y, threads);
+    sum = D_OpenMP(x, y, z, k, d_approx, *primes, factor, threads, is_print);
   }
   else
   {
     FactorTableD<uint32_t> factor(y, z, threads);
-    auto primes = generate_primes<int64_t>(y);
+    SegmentedPrimes<int64_t> primes(y, threads);
     sum = D_OpenMP(x, y, z, k, d_approx, primes, factor, threads, is_print);
   }
 
@@ -14,7 +14,10 @@
 ///
 
 #include <LoadBalancerAC.hpp>
+#include <ElasticThreads.hpp>
+#include <StatusThread.hpp>
 #include <SegmentedPiTable.hpp>
+#include <WorkLog.hpp>
 #include <primecount-config.hpp>
 #include <primecount-internal.hpp>
 #include <imath.hpp>
@@ -22,6 +25,7 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <sstream>
 
@@ -45,7 +49,8 @@ LoadBalancerAC::LoadBalancerAC(int64_t sqrtx,
   x14_(isqrt(sqrtx)),
   y_(y),
   threads_(threads),
-  is_print_(is_print)
+  is_print_(is_print),
+  log_("LoadBalancerAC", sqrtx)
 {
   lock_.init(threads);
 
@@ -77,12 +82,71 @@ LoadBalancerAC::LoadBalancerAC(int64_t sqrtx,
 
   validate_segment_sizes();
   compute_total_segments();
-  print_status();
+
+  // The recorded segments must be handed
+  // out in the same order.
+  bool is_groups = !log_.is_record() && !log_.is_replay();
+  thread_groups_.init(threads_, is_groups);
+  groups_.reset(new ThreadGroup[thread_groups_.size()]);
+
+  for (int i = 0; i < thread_groups_.size(); i++)
+    groups_[i].lock.init(threads_);
+
+  if (is_print_)
+    status_thread_.start([this] { print_status(); });
 }
 
 bool LoadBalancerAC::get_work(int64_t& low, int64_t& high)
 {
-  LockGuard lockGuard(lock_);
+  // Park this thread if too many threads are active
+  elastic_.wait();
+  int g = thread_groups_.get_group();
+  ThreadGroup& group = groups_[g];
+
+  {
+    LockGuard groupGuard(group.lock);
+    if (group.chunk.pop_front(low, high))
+      return true;
+  }
+
+  {
+    LockGuard lockGuard(lock_);
+    LockGuard groupGuard(group.lock);
+
+    // Another thread of this group may
+    // have fetched a new chunk meanwhile.
+    if (group.chunk.pop_front(low, high) ||
+        (get_chunk(g) && group.chunk.pop_front(low, high)))
+      return true;
+  }
+
+  if (steal_unit(groups_.get(), thread_groups_.size(), g, low, high))
+    return true;
+
+  elastic_.finish();
+  return false;
+}
+
+/// Hand out the next chunk of segments to the thread group,
+/// must be called inside the global critical section.
+/// Without thread groups each chunk is a single segment.
+///
+bool LoadBalancerAC::get_chunk(int g)
+{
+  GroupChunk& chunk = groups_[g].chunk;
+
+  // Hand out the recorded segments in the same order
+  if (log_.is_replay())
+  {
+    WorkUnit unit;
+    if (!log_.replay(unit))
+      return false;
+
+    chunk.assign(unit.low, unit.low + unit.segment_size, unit.segment_size);
+    segment_nr_++;
+    publish_status();
+    return true;
+  }
 
   if (low_ >= sqrtx_)
     return false;
@@ -95,14 +159,35 @@ bool LoadBalancerAC::get_work(int64_t& low, int64_t& high)
   if (low_ > y_)
     segment_size_ = large_segment_size_;
 
-  low = low_;
-  high = low + segment_size_;
+  int64_t segments = 1;
+  int groups = thread_groups_.size();
+
+  // Each chunk contains one segment per thread of the
+  // group, but at most the group's share of the
+  // remaining segments. All segments of a chunk must
+  // have the same size, hence the chunk ends at y if
+  // the segment size changes at y.
+  if (groups > 1)
+  {
+    int64_t remaining = ceil_div(sqrtx_ - low_, segment_size_);
+    segments = thread_groups_.threads(g);
+    segments = std::min(segments, remaining / groups);
+    if (low_ <= y_ && segment_size_ != large_segment_size_)
+      segments = std::min(segments, (y_ - low_) / segment_size_ + 1);
+    segments = std::max(segments, (int64_t) 1);
+  }
+
+  int64_t high = low_ + segments * segment_size_;
   high = std::min(high, sqrtx_);
-  low_ = high;
-  segment_nr_++;
-  print_status();
+  chunk.assign(low_, high, segment_size_);
+  low_ = chunk.high;
+  segment_nr_ += segments;
+  publish_status();
 
-  return low < sqrtx_;
+  if (log_.is_record())
+    log_.record({ chunk.low, 1, chunk.high - chunk.low });
+
+  return true;
 }
 
 void LoadBalancerAC::validate_segment_sizes()
@@ -121,22 +206,22 @@ void LoadBalancerAC::compute_total_segments()
   total_segments_ = small_segments + large_segments;
 }
 
-void LoadBalancerAC::print_status()
+/// Called by the worker threads inside the critical section,
+/// the status is printed by the status thread.
+///
+void LoadBalancerAC::publish_status()
 {
   if (is_print_)
-  {
-    double time = get_time();
-    double old = time_;
-    double threshold = 0.1;
+    status_segment_nr_.store(segment_nr_, std::memory_order_relaxed);
+}
 
-    if ((time - old) >= threshold)
-    {
-      time_ = time;
-      std::ostringstream status;
-      status << "\rSegments: " << segment_nr_ << '/' << total_segments_;
-      std::cout << status.str() << std::flush;
-    }
-  }
+/// Called by the status thread every 0.1 seconds
+void LoadBalancerAC::print_status()
+{
+  int64_t segment_nr = status_segment_nr_.load(std::memory_order_relaxed);
+  std::ostringstream status;
+  status << "\rSegments: " << segment_nr << '/' << total_segments_;
+  std::cout << status.str() << std::flush;
 }
 
 } // namespace
@@ -25,6 +25,7 @@
 #include <generate.hpp>
 #include <imath.hpp>
 #include <int128_t.hpp>
+#include <parallel.hpp>
 #include <print.hpp>
 #include <Vector.hpp>
 
@@ -79,16 +80,16 @@ X Phi0_OpenMP(X x,
   int64_t thread_threshold = (int64_t) 1e6;
   threads = ideal_num_threads(y, threads, thread_threshold);
 
-  auto primes = generate_primes<Y>(y);
+  auto primes = generate_primes<Y>(y, threads);
   int64_t pi_y = primes.size() - 1;
   X phi0 = phi_tiny(x, k);
 
-  #pragma omp parallel for schedule(static, 1) num_threads(threads) reduction (+: phi0)
-  for (int64_t b = k + 1; b <= pi_y; b++)
+  phi0 += parallel_for_sum<X>(threads, k + 1, pi_y + 1, 1, [&](int64_t b)
   {
-    phi0 -= phi_tiny(x / primes[b], k);
-    phi0 += Phi0_thread<1>(x, z, b, k, (X) primes[b], primes);
-  }
+    X sum = Phi0_thread<1>(x, z, b, k, (X) primes[b], primes);
+    sum -= phi_tiny(x / primes[b], k);
+    return sum;
+  });
 
   return phi0;
 }
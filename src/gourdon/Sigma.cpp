@@ -20,6 +20,7 @@
 #include <imath.hpp>
 #include <PiTable.hpp>
 #include <print.hpp>
+#include <WarmCache.hpp>
 
 #include <stdint.h>
 
@@ -119,7 +120,8 @@ int64_t Sigma(int64_t x,
   int64_t max_pix_sigma5 = y;
   int64_t max_pix_sigma6 = isqrt(x / x_star);
   int64_t max_pix = max3(max_pix_sigma4, max_pix_sigma5, max_pix_sigma6);
-  PiTable pi(max_pix, threads);
+  auto pi_table = get_pi_table(max_pix, threads);
+  const PiTable& pi = *pi_table;
 
   int64_t a = pi[y];
   int64_t b = pi[iroot<3>(x)];
@@ -160,7 +162,8 @@ int128_t Sigma(int128_t x,
   int64_t max_pix_sigma5 = y;
   int64_t max_pix_sigma6 = isqrt(x / x_star);
   int64_t max_pix = max3(max_pix_sigma4, max_pix_sigma5, max_pix_sigma6);
-  PiTable pi(max_pix, threads);
+  auto pi_table = get_pi_table(max_pix, threads);
+  const PiTable& pi = *pi_table;
 
   int128_t a = pi[y];
   int128_t b = pi[iroot<3>(x)];
@@ -0,0 +1,510 @@
+///
+/// @file  pi_lmo_mod.cpp
+/// @brief Count the primes <= x in an arithmetic progression:
+///        pi(x; q, a) = #{p <= x : p ≡ a (mod q)}, using the
+///        Lagarias-Miller-Odlyzko prime counting algorithm.
+///
+///        In the LMO algorithm each leaf phi(x / n, b) counts the
+///        numbers k <= x / n that are not divisible by any of the
+///        first b primes. In this implementation we additionally
+///        keep track of the residue class of these numbers: the
+///        leaf contributes to pi(x; q, a) only the numbers k with
+///        n * k ≡ a (mod q). If gcd(n, q) = 1 these are the
+///        numbers in a single residue class k ≡ a * n^-1 (mod q).
+///        The unsieved elements of each residue class are counted
+///        using a separate binary indexed tree. The sieving
+///        interval is split into work units that are processed in
+///        parallel, see S2_mod().
+///
+///        LMO formula for primes in arithmetic progressions:
+///        pi(x; q, a) = pi(y; q, a) + S1(x, y)[a] + S2(x, y)[a]
+///                      - [1 ≡ a (mod q)] - P2(x, y)[a]
+///        with y = x^(1/3) and [a] denoting that only the numbers
+///        ≡ a (mod q) are counted.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <primesieve.hpp>
+#include <generate.hpp>
+#include <imath.hpp>
+#include <parallel.hpp>
+#include <print.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+
+using std::min;
+using std::max;
+using namespace primecount;
+
+namespace {
+
+/// Memory usage is O(pi(y) * q)
+constexpr int64_t max_q = 1000;
+
+/// classes[t] contains the residue classes s with:
+/// t * s ≡ a (mod q). If n ≡ t (mod q) then the numbers
+/// k ≡ s (mod q) are the numbers with n * k ≡ a (mod q).
+///
+Vector<Vector<int64_t>> get_classes(int64_t q, int64_t a)
+{
+  Vector<Vector<int64_t>> classes(q);
+
+  for (int64_t t = 0; t < q; t++)
+    for (int64_t s = 0; s < q; s++)
+      if (t * s % q == a)
+        classes[t].push_back(s);
+
+  return classes;
+}
+
+/// Count the odd numbers <= x with n ≡ s (mod q)
+int64_t count_odd(int64_t x, int64_t q, int64_t s)
+{
+  // If q is even all numbers ≡ s (mod q)
+  // have the same parity as s.
+  if (q % 2 == 0)
+  {
+    if (s % 2 == 0)
+      return 0;
+  }
+  else
+  {
+    // n odd and n ≡ s (mod q) <=> n ≡ s' (mod 2q)
+    if (s % 2 == 0)
+      s += q;
+    q *= 2;
+  }
+
+  if (x < s)
+    return 0;
+  else
+    return (x - s) / q + 1;
+}
+
+/// Binary indexed trees (a.k.a. Fenwick trees) that count the
+/// unsieved odd numbers of the current segment [low, high[
+/// separately for each residue class modulo q. The odd numbers
+/// ≡ s (mod q) form an arithmetic progression with difference
+/// step = lcm(2, q), tree[s][i] corresponds to first[s] + i * step.
+///
+class ResidueTrees
+{
+public:
+  ResidueTrees(int64_t q) :
+    q_(q),
+    step_((q % 2) ? q * 2 : q),
+    first_(q),
+    trees_(q)
+  { }
+
+  template <typename T>
+  void init(const T& sieve, int64_t low, int64_t high)
+  {
+    for (int64_t s = 0; s < q_; s++)
+    {
+      // First odd number >= low with n ≡ s (mod q)
+      int64_t n = low + ((s - low % q_) % q_ + q_) % q_;
+      if (n % 2 == 0)
+        n += (q_ % 2) ? q_ : high;
+
+      auto& tree = trees_[s];
+      int64_t size = (n < high) ? (high - 1 - n) / step_ + 1 : 0;
+      tree.resize(size);
+      first_[s] = n;
+
+      for (int64_t i = 0; i < size; i++)
+        tree[i] = sieve[n - low + i * step_];
+
+      // Build the trees in O(size)
+      for (int64_t i = 0; i < size; i++)
+      {
+        int64_t j = i | (i + 1);
+        if (j < size)
+          tree[j] += tree[i];
+      }
+    }
+  }
+
+  /// Update (decrement by 1) the counters after that
+  /// the odd number n has been crossed-off for the
+  /// first time in the sieve array.
+  ///
+  void update(int64_t n)
+  {
+    auto& tree = trees_[n % q_];
+    int64_t size = tree.size();
+    int64_t i = (n - first_[n % q_]) / step_;
+
+    for (; i < size; i |= i + 1)
+      tree[i]--;
+  }
+
+  /// Count the unsieved odd numbers <= n
+  /// in the current segment with n ≡ s (mod q).
+  ///
+  int64_t count(int64_t s, int64_t n) const
+  {
+    const auto& tree = trees_[s];
+    if (n < first_[s] || tree.empty())
+      return 0;
+
+    int64_t i = (n - first_[s]) / step_;
+    i = min(i, (int64_t) tree.size() - 1);
+    int64_t sum = 0;
+
+    for (; i >= 0; i = (i & (i + 1)) - 1)
+      sum += tree[i];
+
+    return sum;
+  }
+
+private:
+  int64_t q_;
+  int64_t step_;
+  Vector<int64_t> first_;
+  Vector<Vector<int32_t>> trees_;
+};
+
+/// Ordinary leaves: sum of mu(n) * phi(x / n, 1)[a]
+/// for the odd square free numbers n <= y.
+///
+int64_t S1_mod(int64_t x,
+               int64_t y,
+               int64_t q,
+               const Vector<Vector<int64_t>>& classes,
+               const Vector<int32_t>& mu)
+{
+  int64_t s1 = 0;
+
+  for (int64_t n = 1; n <= y; n += 2)
+    if (mu[n] != 0)
+      for (int64_t s : classes[n % q])
+        s1 += mu[n] * count_odd(x / n, q, s);
+
+  return s1;
+}
+
+/// The interval [1, x / y[ is split into work units that are
+/// processed in parallel. Each thread counts the special leaves
+/// of its work unit as if there were no unsieved numbers below
+/// low. These missing counts are added when the work units are
+/// combined in ascending order: mu_sum[b * q + s] * phi[b * q + s],
+/// with phi[b * q + s] = number of unsieved elements ≡ s (mod q)
+/// below low after having removed the multiples of the first
+/// b - 1 primes.
+///
+struct WorkUnit
+{
+  int64_t low = 0;
+  int64_t high = 0;
+  int64_t max_b = 0;
+  int64_t sum = 0;
+  // Sum of -mu(m) of the special leaves
+  Vector<int64_t> mu_sum;
+  // Number of unsieved elements in [low, high[
+  Vector<int64_t> phi;
+};
+
+/// Count the special leaves of the interval [low, high[ of the
+/// work unit. This implementation uses the segmented sieve of
+/// Eratosthenes. Prime 2 is not sieved, instead only odd
+/// numbers are counted.
+///
+void S2_unit(int64_t x,
+             int64_t y,
+             int64_t q,
+             int64_t pi_y,
+             int64_t segment_size,
+             const Vector<Vector<int64_t>>& classes,
+             const Vector<int32_t>& primes,
+             const Vector<int32_t>& lpf,
+             const Vector<int32_t>& mu,
+             WorkUnit& unit)
+{
+  int64_t low = unit.low;
+  int64_t max_b = 1;
+
+  // For b > max_b there are no special leaves
+  // in the current work unit.
+  while (max_b + 1 < pi_y &&
+         primes[max_b + 1] < min(x / ((int64_t) primes[max_b + 1] * low), y))
+    max_b++;
+
+  unit.max_b = max_b;
+  unit.sum = 0;
+  unit.mu_sum.resize((max_b + 1) * q);
+  unit.phi.resize((max_b + 1) * q);
+  std::fill(unit.mu_sum.begin(), unit.mu_sum.end(), 0);
+  std::fill(unit.phi.begin(), unit.phi.end(), 0);
+
+  if (max_b < 2)
+    return;
+
+  // next[b] = first odd multiple of primes[b] >= low
+  Vector<int64_t> next(max_b + 1);
+  for (int64_t b = 2; b <= max_b; b++)
+  {
+    int64_t prime = primes[b];
+    int64_t k = max(ceil_div(low, prime), (int64_t) 1) * prime;
+    next[b] = k + prime * (k % 2 == 0);
+  }
+
+  ResidueTrees trees(q);
+  Vector<bool> sieve(segment_size);
+
+  // segmented sieve of Eratosthenes
+  for (; low < unit.high; low += segment_size)
+  {
+    // current segment [low, high[
+    int64_t high = min(low + segment_size, unit.high);
+
+    std::fill(sieve.begin(), sieve.end(), 1);
+    trees.init(sieve, low, high);
+
+    for (int64_t b = 2; b <= max_b; b++)
+    {
+      int64_t prime = primes[b];
+      int64_t min_m = max(x / (prime * high), y / prime);
+      int64_t max_m = min(x / (prime * low), y);
+      int64_t* phi_b = &unit.phi[b * q];
+      int64_t* mu_sum_b = &unit.mu_sum[b * q];
+
+      // Obviously if (prime >= max_m) then (prime >= lpf[max_m])
+      // hence (prime < lpf[m]) will always evaluate to
+      // false and no special leaves are possible.
+      if (prime >= max_m)
+        break;
+
+      for (int64_t m = max_m; m > min_m; m--)
+      {
+        if (mu[m] != 0 && prime < lpf[m])
+        {
+          int64_t n = prime * m;
+          int64_t xn = x / n;
+
+          for (int64_t s : classes[n % q])
+          {
+            int64_t phi_xn = phi_b[s] + trees.count(s, xn);
+            unit.sum -= mu[m] * phi_xn;
+            mu_sum_b[s] -= mu[m];
+          }
+        }
+      }
+
+      // save the number of unsieved elements
+      for (int64_t s = 0; s < q; s++)
+        phi_b[s] += trees.count(s, high - 1);
+
+      // remove the multiples of the b-th prime
+      int64_t k = next[b];
+      for (; k < high; k += prime * 2)
+      {
+        if (sieve[k - low])
+        {
+          sieve[k - low] = 0;
+          trees.update(k);
+        }
+      }
+      next[b] = k;
+    }
+  }
+}
+
+/// Special leaves: sum of -mu(m) * phi(x / (primes[b] * m), b - 1)[a].
+/// The sieving interval [1, x / y[ is processed in rounds of
+/// work units, one work unit per thread. The work units of a
+/// round are combined in ascending order and the size of the
+/// work units is doubled after each round (as most special
+/// leaves are located in the first segments).
+///
+int64_t S2_mod(int64_t x,
+               int64_t y,
+               int64_t q,
+               int64_t pi_y,
+               const Vector<Vector<int64_t>>& classes,
+               const Vector<int32_t>& primes,
+               const Vector<int32_t>& lpf,
+               const Vector<int32_t>& mu,
+               int threads)
+{
+  int64_t limit = x / y;
+  int64_t segment_size = next_power_of_2(isqrt(limit));
+  int64_t thread_threshold = 1 << 20;
+  threads = ideal_num_threads(limit, threads, thread_threshold);
+
+  Vector<WorkUnit> units(threads);
+  Vector<int64_t> phi((pi_y + 1) * q);
+  std::fill(phi.begin(), phi.end(), 0);
+  int64_t s2 = 0;
+  int64_t segments = 1;
+
+  // low must be odd
+  for (int64_t low = 1; low < limit;)
+  {
+    int64_t unit_size = segment_size * segments;
+    int64_t n = 0;
+
+    for (; n < threads && low < limit; n++)
+    {
+      units[n].low = low;
+      units[n].high = min(low + unit_size, limit);
+      low = units[n].high;
+    }
+
+    parallel_for(threads, 0, n, 1, [&](int64_t i)
+    {
+      S2_unit(x, y, q, pi_y, segment_size, classes, primes, lpf, mu, units[i]);
+    });
+
+    for (int64_t i = 0; i < n; i++)
+    {
+      s2 += units[i].sum;
+      for (int64_t j = 2 * q; j < (units[i].max_b + 1) * q; j++)
+      {
+        s2 += units[i].mu_sum[j] * phi[j];
+        phi[j] += units[i].phi[j];
+      }
+    }
+
+    // Keep all threads busy until the end
+    int64_t max_segments = (limit - low) / (threads * segment_size);
+    segments = max(min(segments * 2, max_segments), (int64_t) 1);
+  }
+
+  return s2;
+}
+
+/// 2nd partial sieve function:
+/// Count the numbers p * r <= x with y < p <= r and
+/// p * r ≡ a (mod q), where p and r are primes.
+///
+int64_t P2_mod(int64_t x,
+               int64_t y,
+               int64_t q,
+               const Vector<Vector<int64_t>>& classes)
+{
+  int64_t sqrtx = isqrt(x);
+  int64_t p2 = 0;
+
+  if (y >= sqrtx)
+    return 0;
+
+  // Iterate over the primes y < p <= sqrt(x) in descending
+  // order and over the primes r <= x / p in ascending order.
+  // counts[s] = number of primes r <= x / p with r ≡ s.
+  Vector<int64_t> counts(q);
+  std::fill(counts.begin(), counts.end(), 0);
+  primesieve::iterator rit(sqrtx, y);
+  primesieve::iterator it;
+  int64_t r = (int64_t) it.next_prime();
+
+  for (int64_t p = rit.prev_prime(); p > y; p = rit.prev_prime())
+  {
+    int64_t xp = x / p;
+    for (; r <= xp; r = it.next_prime())
+      counts[r % q]++;
+    for (int64_t s : classes[p % q])
+      p2 += counts[s];
+  }
+
+  // Remove the numbers p * r with r < p.
+  // counts[s] = number of primes r < p with r ≡ s.
+  std::fill(counts.begin(), counts.end(), 0);
+  it.jump_to(0);
+
+  for (int64_t p = it.next_prime(); p <= sqrtx; p = it.next_prime())
+  {
+    if (p > y)
+      for (int64_t s : classes[p % q])
+        p2 -= counts[s];
+    counts[p % q]++;
+  }
+
+  return p2;
+}
+
+} // namespace
+
+namespace primecount {
+
+/// Count the number of primes <= x with p ≡ a (mod q)
+/// using the Lagarias-Miller-Odlyzko algorithm.
+/// @pre 1 <= q <= 1000
+///
+/// Run time: O(x^(2/3) * q)
+/// Memory usage: O(x^(1/3) * (log x)^2 + pi(x^(1/3)) * q * threads)
+///
+int64_t pi_lmo_mod(int64_t x,
+                   int64_t q,
+                   int64_t a,
+                   int threads,
+                   bool is_print)
+{
+  if (q < 1 || q > max_q)
+    throw primecount_error("pi(x, q, a): q must be >= 1 and <= " + std::to_string(max_q));
+
+  a = ((a % q) + q) % q;
+
+  if (x < 2)
+    return 0;
+
+  double alpha = get_alpha_lmo(x);
+  int64_t x13 = iroot<3>(x);
+  int64_t y = (int64_t) (x13 * alpha);
+
+  // Prime 2 is not sieved (only odd numbers
+  // are counted), hence we require y >= 2.
+  y = max(y, (int64_t) 2);
+  int64_t z = x / y;
+
+  if (is_print)
+  {
+    print("");
+    print("=== pi_lmo_mod(x, q, a) ===");
+    print("pi(x, q, a) = S1 + S2 + pi(y, q, a) - [a = 1] - P2");
+    print(x, y, z, 1, threads);
+    print("q = " + std::to_string(q) + ", a = " + std::to_string(a));
+  }
+
+  auto primes = generate_primes<int32_t>(y);
+  auto lpf = generate_lpf(y);
+  auto mu = generate_moebius(y);
+  auto classes = get_classes(q, a);
+
+  int64_t pi_y = primes.size() - 1;
+  int64_t pi_y_a = 0;
+
+  for (int64_t i = 1; i <= pi_y; i++)
+    pi_y_a += (primes[i] % q == a);
+
+  double time = get_time();
+  int64_t p2 = P2_mod(x, y, q, classes);
+  if (is_print)
+    print("P2", p2, time);
+
+  time = get_time();
+  int64_t s1 = S1_mod(x, y, q, classes, mu);
+  if (is_print)
+    print("S1", s1, time);
+
+  time = get_time();
+  int64_t s2 = S2_mod(x, y, q, pi_y, classes, primes, lpf, mu, threads);
+  if (is_print)
+    print("S2", s2, time);
+
+  int64_t phi = s1 + s2;
+  int64_t sum = phi + pi_y_a - (1 % q == a) - p2;
+
+  return sum;
+}
+
+} // namespace
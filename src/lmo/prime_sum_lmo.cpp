@@ -0,0 +1,512 @@
+///
+/// @file  prime_sum_lmo.cpp
+/// @brief Compute the sum of the primes <= x using a weighted
+///        variant of the Lagarias-Miller-Odlyzko algorithm.
+///        Instead of counting the numbers that are not divisible
+///        by any of the first b primes, the partial sieve
+///        function phi_sum(x, b) sums up these numbers:
+///
+///        phi_sum(x, b) = phi_sum(x, b - 1)
+///                      - primes[b] * phi_sum(x / primes[b], b - 1)
+///
+///        Hence the leaves of the LMO algorithm are weighted by
+///        n = primes[b] * m and the special leaves are summed up
+///        using a binary indexed tree that contains the unsieved
+///        numbers (instead of 1) of the current segment.
+///
+///        LMO formula for the prime sum:
+///        prime_sum(x) = prime_sum(y) + S1(x, y) + S2(x, y) - 1 - P2(x, y)
+///        with y = x^(1/3), P2(x, y) = sum of p * q <= x with
+///        y < p <= q.
+///
+///        All intermediate results are computed using unsigned
+///        128-bit integers. Since unsigned integer overflow wraps
+///        around, the intermediate results may overflow as long
+///        as the final result fits into the integer type. The
+///        prime sum up to 1.2 * 10^20 is about 1.58 * 10^38 and
+///        fits into a signed 128-bit integer (< 1.70 * 10^38), for
+///        larger x the result would overflow.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <primesieve.hpp>
+#include <generate.hpp>
+#include <imath.hpp>
+#include <int128_t.hpp>
+#include <parallel.hpp>
+#include <print.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+using std::min;
+using std::max;
+using namespace primecount;
+
+namespace {
+
+/// Binary indexed tree (a.k.a. Fenwick tree) that keeps
+/// track of the sum of the unsieved odd numbers of the
+/// current segment [low, high[. low must be odd.
+/// For x <= 2^63-1 the sum of a segment fits into
+/// uint64_t, for larger x V = maxuint_t is used.
+///
+template <typename V>
+class SumTree
+{
+public:
+  void init(int64_t low, int64_t high)
+  {
+    low_ = low;
+    size_ = (high - low + 1) / 2;
+    tree_.resize(size_);
+
+    for (int64_t i = 0; i < size_; i++)
+      tree_[i] = low + i * 2;
+
+    // Build the tree in O(size)
+    for (int64_t i = 0; i < size_; i++)
+    {
+      int64_t j = i | (i + 1);
+      if (j < size_)
+        tree_[j] += tree_[i];
+    }
+  }
+
+  /// Remove the odd number n after that it
+  /// has been crossed-off for the first time.
+  ///
+  void update(int64_t n)
+  {
+    for (int64_t i = (n - low_) >> 1; i < size_; i |= i + 1)
+      tree_[i] -= n;
+  }
+
+  /// Sum of the unsieved odd numbers <= n
+  V sum(int64_t n) const
+  {
+    V sum = 0;
+    int64_t i = (n - low_) >> 1;
+    for (; i >= 0; i = (i & (i + 1)) - 1)
+      sum += tree_[i];
+    return sum;
+  }
+
+  /// Sum of all unsieved odd numbers
+  V total() const
+  {
+    return sum(low_ + (size_ - 1) * 2);
+  }
+
+private:
+  Vector<V> tree_;
+  int64_t low_ = 0;
+  int64_t size_ = 0;
+};
+
+/// The interval [low, high[ is split into work units that
+/// are processed in parallel. Each thread sums up the
+/// special leaves of its work unit as if the unsieved
+/// numbers below low were 0. These missing sums are
+/// added when the work units are combined in ascending
+/// order: mu_sum[b] * phi[b], with phi[b] = sum of the
+/// unsieved numbers < low.
+///
+struct WorkUnit
+{
+  int64_t low = 0;
+  int64_t high = 0;
+  int64_t max_b = 0;
+  maxuint_t sum = 0;
+  // Sum of -mu(m) * primes[b] * m of the special leaves
+  Vector<maxuint_t> mu_sum;
+  // Sum of the unsieved numbers in [low, high[
+  Vector<maxuint_t> phi;
+};
+
+/// Sum of the odd numbers <= x
+template <typename T>
+maxuint_t phi_sum1(T x)
+{
+  maxuint_t n = (x + 1) / 2;
+  return n * n;
+}
+
+/// Ordinary leaves: sum of mu(n) * n * phi_sum(x / n, 1)
+/// for the odd square free numbers n <= y.
+///
+template <typename T>
+maxuint_t S1_sum(T x,
+                 int64_t y,
+                 const Vector<int32_t>& mu,
+                 int threads)
+{
+  int64_t thread_threshold = 1 << 16;
+  threads = ideal_num_threads(y, threads, thread_threshold);
+  int64_t chunk_size = max((int64_t) 1, y / (threads * 8));
+
+  return parallel_for_sum<maxuint_t>(threads, 0, (y + 1) / 2, chunk_size, [&](int64_t i)
+  {
+    int64_t n = i * 2 + 1;
+    maxuint_t sum = phi_sum1(x / n) * (uint64_t) n;
+    if (mu[n] > 0)
+      return sum;
+    else if (mu[n] < 0)
+      return 0 - sum;
+    else
+      return (maxuint_t) 0;
+  });
+}
+
+/// Sum up the special leaves of the interval [low, high[
+/// of the work unit. Prime 2 is not sieved, instead only
+/// odd numbers are added to the binary indexed tree.
+///
+template <typename V, typename T>
+void S2_unit(T x,
+             int64_t y,
+             int64_t pi_y,
+             int64_t segment_size,
+             const Vector<int32_t>& primes,
+             const Vector<int32_t>& lpf,
+             const Vector<int32_t>& mu,
+             WorkUnit& unit)
+{
+  int64_t low = unit.low;
+  int64_t max_b = 1;
+
+  // For b > max_b there are no special leaves
+  // in the current work unit.
+  while (max_b + 1 < pi_y &&
+         primes[max_b + 1] < min(x / ((T) primes[max_b + 1] * low), (T) y))
+    max_b++;
+
+  unit.max_b = max_b;
+  unit.sum = 0;
+  unit.mu_sum.resize(max_b + 1);
+  unit.phi.resize(max_b + 1);
+  std::fill(unit.mu_sum.begin(), unit.mu_sum.end(), 0);
+  std::fill(unit.phi.begin(), unit.phi.end(), 0);
+
+  if (max_b < 2)
+    return;
+
+  // next[b] = first odd multiple of primes[b] >= low
+  Vector<int64_t> next(max_b + 1);
+  for (int64_t b = 2; b <= max_b; b++)
+  {
+    int64_t prime = primes[b];
+    int64_t k = max(ceil_div(low, prime), (int64_t) 1) * prime;
+    next[b] = k + prime * (k % 2 == 0);
+  }
+
+  SumTree<V> tree;
+  Vector<uint8_t> sieve(segment_size / 2);
+
+  // segmented sieve of Eratosthenes
+  for (; low < unit.high; low += segment_size)
+  {
+    // current segment [low, high[
+    int64_t high = min(low + segment_size, unit.high);
+    std::fill(sieve.begin(), sieve.end(), 1);
+    tree.init(low, high);
+
+    for (int64_t b = 2; b <= max_b; b++)
+    {
+      int64_t prime = primes[b];
+      int64_t min_m = (int64_t) max(x / ((T) prime * high), (T) (y / prime));
+      int64_t max_m = (int64_t) min(x / ((T) prime * low), (T) y);
+
+      // Obviously if (prime >= max_m) then (prime >= lpf[max_m])
+      // hence (prime < lpf[m]) will always evaluate to
+      // false and no special leaves are possible.
+      if (prime >= max_m)
+        break;
+
+      for (int64_t m = max_m; m > min_m; m--)
+      {
+        if (mu[m] != 0 && prime < lpf[m])
+        {
+          uint64_t n = prime * m;
+          int64_t xn = (int64_t) (x / n);
+          maxuint_t phi_xn = unit.phi[b] + tree.sum(xn);
+
+          if (mu[m] > 0)
+          {
+            unit.sum -= phi_xn * n;
+            unit.mu_sum[b] -= n;
+          }
+          else
+          {
+            unit.sum += phi_xn * n;
+            unit.mu_sum[b] += n;
+          }
+        }
+      }
+
+      unit.phi[b] += tree.total();
+
+      // remove the multiples of the b-th prime
+      int64_t k = next[b];
+      for (; k < high; k += prime * 2)
+      {
+        if (sieve[(k - low) >> 1])
+        {
+          sieve[(k - low) >> 1] = 0;
+          tree.update(k);
+        }
+      }
+      next[b] = k;
+    }
+  }
+}
+
+/// Special leaves: sum of -mu(m) * primes[b] * m *
+/// phi_sum(x / (primes[b] * m), b - 1). The sieving interval
+/// [1, z] is processed in rounds of work units, one work
+/// unit per thread. The work units of a round are combined
+/// in ascending order and the size of the work units is
+/// doubled after each round (as most special leaves are
+/// located in the first segments).
+///
+template <typename V, typename T>
+maxuint_t S2_sum(T x,
+                 int64_t y,
+                 int64_t z,
+                 int64_t pi_y,
+                 const Vector<int32_t>& primes,
+                 const Vector<int32_t>& lpf,
+                 const Vector<int32_t>& mu,
+                 int threads)
+{
+  int64_t limit = z + 1;
+  int64_t segment_size = next_power_of_2(isqrt(limit));
+  segment_size = max(segment_size, (int64_t) 64);
+  int64_t thread_threshold = 1 << 20;
+  threads = ideal_num_threads(limit, threads, thread_threshold);
+
+  Vector<WorkUnit> units(threads);
+  Vector<maxuint_t> phi(pi_y + 1);
+  std::fill(phi.begin(), phi.end(), 0);
+  maxuint_t sum = 0;
+  int64_t segments = 1;
+
+  // low must be odd
+  for (int64_t low = 1; low < limit;)
+  {
+    int64_t unit_size = segment_size * segments;
+    int64_t n = 0;
+
+    for (; n < threads && low < limit; n++)
+    {
+      units[n].low = low;
+      units[n].high = min(low + unit_size, limit);
+      low = units[n].high;
+    }
+
+    parallel_for(threads, 0, n, 1, [&](int64_t i)
+    {
+      S2_unit<V>(x, y, pi_y, segment_size, primes, lpf, mu, units[i]);
+    });
+
+    for (int64_t i = 0; i < n; i++)
+    {
+      sum += units[i].sum;
+      for (int64_t b = 2; b <= units[i].max_b; b++)
+      {
+        sum += units[i].mu_sum[b] * phi[b];
+        phi[b] += units[i].phi[b];
+      }
+    }
+
+    // Keep all threads busy until the end
+    int64_t max_segments = (limit - low) / (threads * segment_size);
+    segments = max(min(segments * 2, max_segments), (int64_t) 1);
+  }
+
+  return sum;
+}
+
+/// 2nd partial sieve function:
+/// Sum of the numbers p * q <= x with y < p <= q,
+/// where p and q are primes.
+///
+template <typename T>
+maxuint_t P2_sum(T x, int64_t y)
+{
+  int64_t sqrtx = (int64_t) isqrt(x);
+  maxuint_t sum = 0;
+  maxuint_t prime_sum = 0;
+
+  if (y >= sqrtx)
+    return 0;
+
+  // Iterate over the primes y < p <= sqrt(x) in descending
+  // order and over the primes q <= x / p in ascending order.
+  // prime_sum = sum of the primes q <= x / p.
+  primesieve::iterator rit(sqrtx, y);
+  primesieve::iterator it;
+  uint64_t q = it.next_prime();
+
+  for (uint64_t p = rit.prev_prime(); p > (uint64_t) y; p = rit.prev_prime())
+  {
+    uint64_t xp = (uint64_t) (x / p);
+    for (; q <= xp; q = it.next_prime())
+      prime_sum += q;
+    sum += prime_sum * p;
+  }
+
+  // Remove the numbers p * q with q < p.
+  // prime_sum = sum of the primes q < p.
+  prime_sum = 0;
+  it.jump_to(0);
+
+  for (uint64_t p = it.next_prime(); p <= (uint64_t) sqrtx; p = it.next_prime())
+  {
+    if (p > (uint64_t) y)
+      sum -= prime_sum * p;
+    prime_sum += p;
+  }
+
+  return sum;
+}
+
+/// Calculate the sum of the primes <= x using a weighted
+/// variant of the Lagarias-Miller-Odlyzko algorithm.
+///
+template <typename V, typename T>
+maxint_t prime_sum_lmo_OpenMP(T x,
+                              int threads,
+                              bool is_print,
+                              const std::string& name)
+{
+  if (x < 2)
+    return 0;
+
+  double alpha = get_alpha_lmo(x);
+  int64_t x13 = (int64_t) iroot<3>(x);
+  int64_t y = (int64_t) (x13 * alpha);
+
+  // Prime 2 is not sieved (only odd numbers
+  // are added up), hence we require y >= 2.
+  y = max(y, (int64_t) 2);
+  int64_t z = (int64_t) (x / y);
+
+  if (is_print)
+  {
+    print("");
+    print("=== " + name + "(x) ===");
+    print("prime_sum(x) = S1 + S2 + prime_sum(y) - 1 - P2");
+    print(x, y, z, 1, threads);
+  }
+
+  auto primes = generate_primes<int32_t>(y);
+  auto lpf = generate_lpf(y);
+  auto mu = generate_moebius(y);
+
+  int64_t pi_y = primes.size() - 1;
+  maxuint_t prime_sum_y = 0;
+
+  for (int64_t i = 1; i <= pi_y; i++)
+    prime_sum_y += primes[i];
+
+  double time = get_time();
+  maxuint_t p2 = P2_sum(x, y);
+  if (is_print)
+    print("P2", (maxint_t) p2, time);
+
+  time = get_time();
+  maxuint_t s1 = S1_sum(x, y, mu, threads);
+  if (is_print)
+    print("S1", (maxint_t) s1, time);
+
+  time = get_time();
+  maxuint_t s2 = S2_sum<V>(x, y, z, pi_y, primes, lpf, mu, threads);
+  if (is_print)
+    print("S2", (maxint_t) s2, time);
+
+  maxuint_t sum = s1 + s2 + prime_sum_y - 1 - p2;
+
+  return (maxint_t) sum;
+}
+
+} // namespace
+
+namespace primecount {
+
+/// Calculate the sum of the primes <= x using a weighted
+/// variant of the Lagarias-Miller-Odlyzko algorithm.
+/// Run time: O(x^(2/3))
+/// Memory usage: O(x^(1/3) * (log x)^2)
+///
+maxint_t prime_sum_lmo(int64_t x,
+                       int threads,
+                       bool is_print)
+{
+#if !defined(HAVE_INT128_T)
+  // The prime sum must fit into maxint_t
+  if (x > (int64_t) 1e10)
+    throw primecount_error("prime_sum(x): x must be <= 10^10");
+#endif
+
+  if (x < 2)
+    return 0;
+
+  return prime_sum_lmo_OpenMP<uint64_t>(x, threads, is_print, "prime_sum_lmo");
+}
+
+#ifdef HAVE_INT128_T
+
+/// Calculate the sum of the primes <= x using a weighted
+/// variant of the Lagarias-Miller-Odlyzko algorithm.
+/// Run time: O(x^(2/3))
+/// Memory usage: O(x^(1/3) * (log x)^2)
+///
+int128_t prime_sum_lmo(int128_t x,
+                       int threads,
+                       bool is_print)
+{
+  // Prevent 64-bit cast to random
+  // integer if x <= -2^63.
+  if (x < 2)
+    return 0;
+
+  // Use 64-bit if possible
+  if (x <= std::numeric_limits<int64_t>::max())
+    return prime_sum_lmo((int64_t) x, threads, is_print);
+  else
+    return prime_sum_lmo_128(x, threads, is_print);
+}
+
+/// 128-bit version of prime_sum_lmo(x), also used for
+/// testing the 128-bit code path using small x.
+/// Run time: O(x^(2/3))
+/// Memory usage: O(x^(1/3) * (log x)^2)
+///
+int128_t prime_sum_lmo_128(int128_t x,
+                           int threads,
+                           bool is_print)
+{
+  if (x < 2)
+    return 0;
+
+  // The prime sum must fit into int128_t
+  int128_t limit = 12 * ipow<19>((int128_t) 10);
+  if (x > limit)
+    throw primecount_error("prime_sum(x): x must be <= 1.2 * 10^20");
+
+  return prime_sum_lmo_OpenMP<maxuint_t>(x, threads, is_print, "prime_sum_lmo_128");
+}
+
+#endif
+
+} // namespace
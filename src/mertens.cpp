@@ -0,0 +1,502 @@
+///
+/// @file  mertens.cpp
+/// @brief Compute the Mertens function M(x) = \sum_{n=1}^{x} mu(n)
+///        using the algorithm of Deleglise and Rivat:
+///
+///        M(x) = M(u) - \sum_{m=1}^{u} mu(m) \sum_{u/m < n <= x/m} M(x / (m * n))
+///
+///        with u ~ x^(1/3). All values v = x / (m * n) are <= z
+///        with z = x / u, the M(v) values are generated using a
+///        segmented sieve of the Moebius function. For each m the
+///        leaves with n <= sqrt(x / m) are processed individually,
+///        the leaves with n > sqrt(x / m) are grouped by their
+///        value v <= sqrt(x / m) since there are many different n
+///        with the same value x / (m * n).
+///
+///        This implementation uses the same parallelization scheme
+///        as S2_hard.cpp: the sieving interval [0, z] is distributed
+///        to the threads using LoadBalancerS2 and each thread
+///        computes M(low - 1) of its work unit from scratch (like
+///        the phi(x, a) values in S2_hard), hence the threads are
+///        completely independent from each other.
+///
+///        Paper: Marc Deleglise, Joel Rivat, Computing the summation
+///        of the Moebius function, Experimental Mathematics, Vol. 5,
+///        1996, pp. 291-295.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <LoadBalancerS2.hpp>
+#include <fast_div.hpp>
+#include <generate.hpp>
+#include <imath.hpp>
+#include <int128_t.hpp>
+#include <macros.hpp>
+#include <min.hpp>
+#include <parallel.hpp>
+#include <print.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+using namespace primecount;
+
+namespace {
+
+/// For x <= mertens_sieve_threshold M(x) is computed
+/// using a simple sieve of the Moebius function.
+const int64_t mertens_sieve_threshold = 1 << 20;
+
+/// A squarefree m <= u with its leaves x / (m * n)
+struct Leaf
+{
+  int64_t m;
+  int64_t mu;
+  // Leaves with n_min < n <= sqrt_xm
+  // are processed individually.
+  int64_t n_min;
+  int64_t sqrt_xm;
+  // Leaves with n > max(n_min, sqrt_xm) are grouped
+  // by their value v = x / (m * n) <= max_v.
+  int64_t max_v;
+};
+
+/// Leaves and sieving primes, these are
+/// shared by all threads.
+///
+struct MertensData
+{
+  int64_t u;
+  int64_t z;
+  int64_t M_u;
+  int64_t max_segment_size;
+  Vector<Leaf> leaves;
+  Vector<int32_t> primes;
+};
+
+int64_t mertens_noprint(int64_t x);
+
+/// u = 2 * x^(1/3) has been tuned empirically, sieving is
+/// more expensive than processing the leaves hence u is
+/// slightly larger than x^(1/3).
+///
+template <typename T>
+int64_t get_u(T x)
+{
+  T u = iroot<3>(x) * 2;
+  return (int64_t) min(u, x);
+}
+
+/// M(x) using a simple sieve of the Moebius function
+int64_t mertens_sieve(int64_t x)
+{
+  auto mu = generate_moebius(x);
+  int64_t sum = 0;
+
+  for (int64_t n = 1; n <= x; n++)
+    sum += mu[n];
+
+  return sum;
+}
+
+template <typename T>
+MertensData get_mertens_data(T x, int64_t u)
+{
+  MertensData data;
+  data.u = u;
+  data.z = (int64_t) (x / u);
+  data.M_u = 0;
+  data.primes = generate_primes<int32_t>(isqrt(data.z));
+
+  // LoadBalancerS2 is tuned for the Sieve class which uses
+  // 1 bit per number, MertensSieve uses 12 bytes per
+  // number hence we use smaller segments that fit
+  // into the CPU's cache.
+  data.max_segment_size = max(isqrt(data.z), 1 << 14);
+  auto mu = generate_moebius(u);
+
+  for (int64_t m = 1; m <= u; m++)
+  {
+    data.M_u += mu[m];
+    if (mu[m] != 0)
+    {
+      T xm = x / m;
+      int64_t n_min = u / m;
+      int64_t sqrt_xm = (int64_t) isqrt(xm);
+      int64_t n_max = max(n_min, sqrt_xm);
+      int64_t max_v = (int64_t) (xm / (n_max + 1));
+      data.leaves.push_back({m, mu[m], n_min, sqrt_xm, max_v});
+    }
+  }
+
+  return data;
+}
+
+/// Segmented sieve of the Moebius function, computes
+/// M(n) for the numbers inside [low, high[.
+///
+class MertensSieve
+{
+public:
+  MertensSieve(int64_t low,
+               int64_t M_low,
+               int64_t segment_size,
+               const Vector<int32_t>& primes)
+    : low_(low),
+      high_(low),
+      M_low_(M_low),
+      primes_(primes)
+  {
+    prod_.resize(segment_size);
+    mertens_.resize(segment_size);
+  }
+
+  /// Sieve the next segment [high_, high[
+  void sieve(int64_t high)
+  {
+    ASSERT(high - high_ <= (int64_t) mertens_.size());
+
+    if (high_ > low_)
+      M_low_ += mertens_[high_ - low_ - 1];
+
+    low_ = high_;
+    high_ = high;
+    int64_t size = high - low_;
+    std::fill_n(prod_.begin(), size, 1);
+
+    // mu(0) = 0
+    if (low_ == 0)
+      prod_[0] = 0;
+
+    // Add the primes with prime^2 < high
+    while (multiples_.size() + 1 < primes_.size())
+    {
+      int64_t prime = primes_[multiples_.size() + 1];
+      int64_t square = prime * prime;
+      if (square >= high)
+        break;
+      int64_t multiple = ceil_div(low_, prime) * prime;
+      int64_t square_multiple = ceil_div(low_, square) * square;
+      multiples_.push_back({multiple, square_multiple});
+    }
+
+    // prod_[i] = (-1)^k * p1 * ... * pk with p1...pk
+    // being the distinct sieving primes dividing
+    // low + i, or 0 if low + i is not squarefree.
+    for (std::size_t i = 0; i < multiples_.size(); i++)
+    {
+      int64_t prime = primes_[i + 1];
+      int64_t square = prime * prime;
+      int64_t n = multiples_[i].first;
+
+      for (; n < high; n += prime)
+        prod_[n - low_] *= -prime;
+
+      multiples_[i].first = n;
+      n = multiples_[i].second;
+
+      for (; n < high; n += square)
+        prod_[n - low_] = 0;
+
+      multiples_[i].second = n;
+    }
+
+    // Numbers that are not fully factored by the
+    // sieving primes have exactly one large prime
+    // factor > sqrt(high).
+    int32_t sum = 0;
+
+    for (int64_t i = 0; i < size; i++)
+    {
+      int64_t n = low_ + i;
+      int64_t prod = prod_[i];
+      int32_t mu = (prod > 0) - (prod < 0);
+      if (prod != n && prod != -n)
+        mu = -mu;
+      sum += mu;
+      mertens_[i] = sum;
+    }
+  }
+
+  /// Returns M(n) with low <= n < high
+  ALWAYS_INLINE int64_t M(int64_t n) const
+  {
+    ASSERT(n >= low_ && n < high_);
+    return M_low_ + mertens_[n - low_];
+  }
+
+private:
+  int64_t low_;
+  int64_t high_;
+  int64_t M_low_;
+  const Vector<int32_t>& primes_;
+  // Next multiple of prime and prime^2
+  Vector<std::pair<int64_t, int64_t>> multiples_;
+  Vector<int64_t> prod_;
+  // mertens_[i] = M(low + i) - M(low - 1)
+  Vector<int32_t> mertens_;
+};
+
+/// Compute the contribution of the leaves with
+/// low <= x / (m * n) < low + segments * segment_size.
+/// The leaves that are processed individually are
+/// stored in a bucket list, one bucket per segment.
+/// Each leaf is moved to the bucket of the segment
+/// that contains its next value x / (m * n).
+///
+template <typename T>
+T mertens_thread(T x,
+                 const MertensData& data,
+                 ThreadData& thread)
+{
+  using UT = typename std::make_unsigned<T>::type;
+  UT sum = 0;
+
+  int64_t low = thread.low;
+  int64_t low1 = max(low, 1);
+  int64_t limit = min(low + thread.segments * thread.segment_size, data.z + 1);
+  int64_t segment_size = min(thread.segment_size, data.max_segment_size);
+  int64_t segments = ceil_div(limit - low, segment_size);
+  const Vector<Leaf>& leaves = data.leaves;
+
+  if (low >= limit)
+    return 0;
+
+  // next_n[i] = largest n of leaves[i] with x / (m * n) >= low
+  Vector<int64_t> next_n(leaves.size());
+  Vector<int32_t> next_leaf(leaves.size());
+  Vector<int32_t> bucket(segments);
+  std::fill(bucket.begin(), bucket.end(), -1);
+
+  for (std::size_t i = 0; i < leaves.size(); i++)
+  {
+    const Leaf& leaf = leaves[i];
+    if (leaf.sqrt_xm <= leaf.n_min)
+      continue;
+    T xm = x / leaf.m;
+    int64_t n = min(fast_div(xm, low1), leaf.sqrt_xm);
+    if (n <= leaf.n_min)
+      continue;
+    int64_t v = fast_div64(xm, n);
+    if (v >= limit)
+      continue;
+    int64_t s = (v - low) / segment_size;
+    next_n[i] = n;
+    next_leaf[i] = bucket[s];
+    bucket[s] = (int32_t) i;
+  }
+
+  int64_t M_low = mertens_noprint(low - 1);
+  MertensSieve sieve(low, M_low, segment_size, data.primes);
+  thread.init_finished();
+
+  for (int64_t s = 0; s < segments; s++)
+  {
+    // Stop if the backup copy of this
+    // work unit has already finished.
+    if (thread.is_cancelled())
+      break;
+
+    // current segment [low, high[
+    low = thread.low + s * segment_size;
+    int64_t high = min(low + segment_size, limit);
+    sieve.sieve(high);
+
+    // Process the leaves x / (m * n) with n <= sqrt(x / m)
+    for (int32_t i = bucket[s]; i != -1;)
+    {
+      const Leaf& leaf = leaves[i];
+      int32_t next = next_leaf[i];
+      T xm = x / leaf.m;
+      int64_t n = next_n[i];
+      int64_t v = fast_div64(xm, n);
+      UT leaves_sum = 0;
+
+      while (v < high)
+      {
+        leaves_sum += (UT) sieve.M(v);
+        if (--n <= leaf.n_min)
+          break;
+        v = fast_div64(xm, n);
+      }
+
+      sum -= (UT) leaf.mu * leaves_sum;
+
+      if (n > leaf.n_min && v < limit)
+      {
+        int64_t t = (v - thread.low) / segment_size;
+        next_n[i] = n;
+        next_leaf[i] = bucket[t];
+        bucket[t] = i;
+      }
+
+      i = next;
+    }
+
+    // Process the leaves x / (m * n) with n > sqrt(x / m),
+    // max_v decreases as m increases.
+    int64_t low1 = max(low, 1);
+
+    for (std::size_t i = 0; i < leaves.size(); i++)
+    {
+      const Leaf& leaf = leaves[i];
+      if (leaf.max_v < low1)
+        break;
+
+      T xm = x / leaf.m;
+      int64_t n_max = max(leaf.n_min, leaf.sqrt_xm);
+      int64_t max_v = min(leaf.max_v, high - 1);
+      T xmv = fast_div(xm, low1);
+      UT leaves_sum = 0;
+
+      // There are x / (m * v) - x / (m * (v + 1))
+      // leaves with value v.
+      for (int64_t v = low1; v <= max_v; v++)
+      {
+        T xmv1 = fast_div(xm, v + 1);
+        T count = xmv - max(xmv1, (T) n_max);
+        leaves_sum += (UT) sieve.M(v) * (UT) count;
+        xmv = xmv1;
+      }
+
+      sum -= (UT) leaf.mu * leaves_sum;
+    }
+  }
+
+  return (T) sum;
+}
+
+/// Single-threaded M(x), used to compute
+/// M(low - 1) for each work unit.
+///
+int64_t mertens_noprint(int64_t x)
+{
+  if (x <= mertens_sieve_threshold)
+    return mertens_sieve(max(x, 0));
+
+  int64_t u = get_u(x);
+  auto data = get_mertens_data(x, u);
+
+  ThreadData thread;
+  thread.low = 0;
+  thread.segment_size = data.max_segment_size;
+  thread.segments = ceil_div(data.z + 1, thread.segment_size);
+  thread.start_time();
+
+  uint64_t sum = data.M_u;
+  sum += mertens_thread(x, data, thread);
+  return (int64_t) sum;
+}
+
+/// Calculate M(x) in parallel using the
+/// same load balancing as S2_hard(x, y).
+///
+template <typename T>
+T mertens_OpenMP(T x,
+                 int threads,
+                 bool is_print)
+{
+  if (x < 1)
+    return 0;
+
+  int64_t u = get_u(x);
+  auto data = get_mertens_data(x, u);
+  double time;
+
+  if (is_print)
+  {
+    print("");
+    print("=== mertens(x) ===");
+    print("M(x) = M(u) - \\sum_{m=1}^{u} mu(m) \\sum_{u/m < n <= x/m} M(x / (m * n))");
+    print_vars(x, u, threads);
+    time = get_time();
+  }
+
+  // Unlike the sum of the hard special leaves, the sum of the
+  // leaves of M(x) is not monotonic, hence the status is
+  // computed from the sieving progress only.
+  maxint_t sum_approx = std::numeric_limits<maxint_t>::max();
+  int64_t thread_threshold = 1 << 20;
+  threads = ideal_num_threads(data.z, threads, thread_threshold);
+  LoadBalancerS2 loadBalancer(x, data.z + 1, sum_approx, threads, is_print);
+
+  parallel(threads, [&](int)
+  {
+    ThreadData thread;
+
+    while (loadBalancer.get_work(thread))
+    {
+      thread.start_time();
+      thread.sum = mertens_thread(x, data, thread);
+      thread.stop_time();
+    }
+  });
+
+  // Compute modulo 2^bits, the final
+  // result always fits into T.
+  using UT = typename std::make_unsigned<T>::type;
+  UT sum = (UT) data.M_u;
+  sum += (UT) loadBalancer.get_sum();
+  T res = (T) sum;
+
+  if (is_print)
+    print("M(x)", res, time);
+
+  return res;
+}
+
+} // namespace
+
+namespace primecount {
+
+/// Compute the Mertens function M(x).
+/// Run time: O(x^(2/3) log log x)
+/// Memory usage: O(x^(1/3))
+///
+int64_t mertens(int64_t x,
+                int threads,
+                bool is_print)
+{
+  return mertens_OpenMP(x, threads, is_print);
+}
+
+#ifdef HAVE_INT128_T
+
+/// Compute the Mertens function M(x).
+/// Run time: O(x^(2/3) log log x)
+/// Memory usage: O(x^(1/3))
+///
+int128_t mertens(int128_t x,
+                 int threads,
+                 bool is_print)
+{
+  // Prevent 64-bit cast to random
+  // integer if x <= -2^63.
+  if (x < 1)
+    return 0;
+
+  // Use 64-bit if possible
+  if (x <= std::numeric_limits<int64_t>::max())
+    return mertens((int64_t) x, threads, is_print);
+
+  // The M(v) values are sieved up to z = x^(2/3),
+  // z must fit into a 64-bit integer.
+  maxint_t limit = ipow<27>((maxint_t) 10);
+  if (x > limit)
+    throw primecount_error("mertens(x): x must be <= 10^27");
+
+  return mertens_OpenMP(x, threads, is_print);
+}
+
+#endif
+
+} // namespace
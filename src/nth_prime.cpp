@@ -11,6 +11,7 @@
 #include <primecount.hpp>
 #include <primecount-internal.hpp>
 #include <primesieve.hpp>
+#include <PiStore.hpp>
 #include <PiTable.hpp>
 #include <Vector.hpp>
 #include <imath.hpp>
@@ -98,13 +99,16 @@ int64_t nth_prime(int64_t n, int threads)
   if (n <= PiTable::pi_cache(PiTable::max_cached()))
     return binary_search_nth_prime(n);
 
+  int64_t prime = -1;
+  if (nth_prime_store_lookup(n, prime))
+    return prime;
+
   // Closely approximate the nth prime using the inverse
   // Riemann R function and then count the primes up to this
   // approximation using the prime counting function.
   int64_t prime_approx = RiemannR_inverse(n);
   int64_t count_approx = pi(prime_approx, threads);
   int64_t avg_prime_gap = ilog(prime_approx) + 2;
-  int64_t prime = -1;
 
   // Here we are very close to the nth prime < sqrt(nth_prime),
   // we simply iterate over the primes until we find it.
@@ -125,6 +129,7 @@ int64_t nth_prime(int64_t n, int threads)
       prime = iter.prev_prime();
   }
 
+  pi_store_insert(prime, n, "nth_prime");
   return prime;
 }
 
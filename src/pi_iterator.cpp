@@ -0,0 +1,118 @@
+///
+/// @file  pi_iterator.cpp
+/// @brief pi_iterator computes pi(x) for a sequence of nearby x
+///        values. After the initial pi(x0) computation the
+///        iterator only counts the primes inside ]x0, x] (or
+///        ]x, x0] in reverse direction) using primesieve's
+///        segmented sieve of Eratosthenes. Large intervals are
+///        split into chunks that are sieved in parallel.
+///
+///        Sieving an interval of size d takes O(d) operations
+///        whereas the prime counting function runs in
+///        O(x^(2/3) / (log x)^2). Hence if the distance between
+///        the old and the new x is large pi(x) is computed from
+///        scratch instead.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <generate.hpp>
+#include <imath.hpp>
+#include <parallel.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using namespace primecount;
+
+/// Returns true if sieving an interval of size dist
+/// is faster than computing pi(x) from scratch. The
+/// constant has been determined by benchmarking
+/// count_primes(x, x + dist) against pi(x) for
+/// x in [10^9, 10^15]. Both the sieve and the prime
+/// counting function scale well with the number of
+/// threads, hence threads is not part of the formula.
+///
+bool is_sieve_faster(int64_t x, int64_t dist)
+{
+  double logx = std::log(std::max((double) x, 8.0));
+  double pix_cost = std::pow((double) x, 2.0 / 3.0) / (logx * logx);
+  double max_dist = pix_cost * 600;
+  return (double) dist <= max_dist;
+}
+
+/// Count the primes inside [low, high].
+/// Large intervals are split into chunks
+/// that are sieved in parallel.
+///
+int64_t count_primes_parallel(int64_t low, int64_t high, int threads)
+{
+  if (low > high)
+    return 0;
+
+  int64_t dist = high - low + 1;
+  int64_t thread_threshold = (int64_t) 1e7;
+  threads = ideal_num_threads(dist, threads, thread_threshold);
+
+  if (threads == 1)
+    return count_primes(low, high);
+
+  // Multiple chunks per thread for load balancing
+  int64_t chunks = threads * 4;
+  int64_t chunk_size = ceil_div(dist, chunks);
+
+  return parallel_for_sum<int64_t>(threads, 0, chunks, 1, [&](int64_t i)
+  {
+    int64_t start = low + chunk_size * i;
+    int64_t stop = std::min(start + chunk_size - 1, high);
+    return count_primes(start, stop);
+  });
+}
+
+} // namespace
+
+namespace primecount {
+
+pi_iterator::pi_iterator(int64_t x)
+  : pi_iterator(x, get_num_threads())
+{ }
+
+pi_iterator::pi_iterator(int64_t x, int threads)
+  : x_(x),
+    pi_(pi_noprint(x, threads)),
+    threads_(threads)
+{ }
+
+int64_t pi_iterator::advance_to(int64_t x)
+{
+  if (x == x_)
+    return pi_;
+
+  // pi(x) = 0 for x < 2
+  int64_t low = std::max(std::min(x, x_), (int64_t) 1);
+  int64_t high = std::max(x, x_);
+
+  if (low >= high)
+    pi_ = 0;
+  else if (!is_sieve_faster(high, high - low))
+    pi_ = pi_noprint(x, threads_);
+  else
+  {
+    // Count the primes inside ]low, high]
+    int64_t count = count_primes_parallel(low + 1, high, threads_);
+    pi_ = (x > x_) ? pi_ + count : pi_ - count;
+  }
+
+  x_ = x;
+  return pi_;
+}
+
+} // namespace
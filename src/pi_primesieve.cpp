@@ -1,10 +1,10 @@
 ///
 /// @file  pi_primesieve.cpp
-/// @brief Count primes using the primesieve C/C++ library which
-///        uses a highly optimized parallel implementation of the
-///        segmented sieve of Eratosthenes.
+/// @brief Count (and sum up) primes using the primesieve C/C++
+///        library which uses a highly optimized parallel
+///        implementation of the segmented sieve of Eratosthenes.
 ///
-/// Copyright (C) 2019 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -12,6 +12,7 @@
 
 #include <primecount-internal.hpp>
 #include <primesieve.hpp>
+#include <int128_t.hpp>
 
 #include <stdint.h>
 
@@ -25,4 +26,23 @@ int64_t pi_primesieve(int64_t x)
     return primesieve::count_primes(0, x);
 }
 
+/// Sum of the primes <= x using the sieve of Eratosthenes,
+/// used for checking the results of prime_sum_lmo(x).
+///
+maxint_t prime_sum_primesieve(int64_t x)
+{
+  maxint_t sum = 0;
+
+  if (x < 2)
+    return sum;
+
+  primesieve::iterator it(0, x);
+  uint64_t prime = it.next_prime();
+
+  for (; prime <= (uint64_t) x; prime = it.next_prime())
+    sum += prime;
+
+  return sum;
+}
+
 } // namespace
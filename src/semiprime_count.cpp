@@ -0,0 +1,145 @@
+///
+/// @file  semiprime_count.cpp
+/// @brief Count the semiprimes <= x, i.e. the numbers <= x that
+///        are the product of exactly 2 (not necessarily distinct)
+///        prime factors:
+///
+///        pi_2(x) = \sum_{p <= sqrt(x)} pi(x / p) - pi(p) + 1
+///
+///        The semiprimes p * q <= x with y < p <= q are counted
+///        by the 2nd partial sieve function P2(x, y) which
+///        computes the pi(x / p) values using a parallel prime
+///        sieve (LoadBalancerP2). For the primes p <= y we
+///        compute pi(x / p) using the prime counting function:
+///
+///        pi_2(x) = P2(x, y) + \sum_{i=1}^{a} pi(x / primes[i]) - a * (a - 1) / 2
+///        with a = pi(y).
+///
+///        y = x^(2/7) balances the time spent in P2(x, y), which
+///        sieves up to x / y, and the time spent computing the
+///        pi(x / p) values with p <= y. Computing pi(x / p) for
+///        the smallest primes p dominates the run time, hence
+///        y is much smaller than x^(1/3) (which would balance the
+///        asymptotic run times).
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount-internal.hpp>
+#include <primesieve.hpp>
+#include <gourdon.hpp>
+#include <imath.hpp>
+#include <int128_t.hpp>
+#include <print.hpp>
+
+#include <stdint.h>
+#include <cmath>
+#include <limits>
+
+using namespace primecount;
+
+namespace {
+
+int64_t pi_xp(int64_t x, int threads)
+{
+  return pi_noprint(x, threads);
+}
+
+#ifdef HAVE_INT128_T
+
+int128_t pi_xp(int128_t x, int threads)
+{
+  // Use 64-bit if possible
+  if (x <= std::numeric_limits<int64_t>::max())
+    return pi_noprint((int64_t) x, threads);
+  else
+    return pi_gourdon_128(x, threads, false);
+}
+
+#endif
+
+template <typename T>
+T semiprime_count_OpenMP(T x,
+                         int threads,
+                         bool is_print)
+{
+  if (x < 4)
+    return 0;
+
+  int64_t y = (int64_t) std::pow((double) x, 2.0 / 7);
+  int64_t a = pi_noprint(y, threads);
+  double time;
+
+  if (is_print)
+  {
+    print("");
+    print("=== semiprime_count(x) ===");
+    print("pi_2(x) = P2(x, y) + \\sum_{i=1}^{a} pi(x / primes[i]) - a * (a - 1) / 2");
+    print_vars(x, y, threads);
+  }
+
+  T sum = P2(x, y, a, threads, is_print);
+  sum -= (T) a * (a - 1) / 2;
+
+  if (is_print)
+    time = get_time();
+
+  // \sum_{i=1}^{a} pi(x / primes[i])
+  primesieve::iterator it(0, y);
+  int64_t prime = it.next_prime();
+  T pi_sum = 0;
+
+  for (; prime <= y; prime = it.next_prime())
+    pi_sum += pi_xp(x / prime, threads);
+
+  if (is_print)
+    print("pi(x / p)", pi_sum, time);
+
+  sum += pi_sum;
+
+  return sum;
+}
+
+} // namespace
+
+namespace primecount {
+
+/// Count the semiprimes <= x.
+/// Run time: O(x^(16/21) / (log x)^2)
+/// Memory usage: O(x^(1/2))
+///
+int64_t semiprime_count(int64_t x,
+                        int threads,
+                        bool is_print)
+{
+  return semiprime_count_OpenMP(x, threads, is_print);
+}
+
+#ifdef HAVE_INT128_T
+
+/// Count the semiprimes <= x.
+/// Run time: O(x^(16/21) / (log x)^2)
+/// Memory usage: O(x^(1/2))
+///
+int128_t semiprime_count(int128_t x,
+                         int threads,
+                         bool is_print)
+{
+  // Prevent 64-bit cast to random
+  // integer if x <= -2^63.
+  if (x < 4)
+    return 0;
+
+  // Use 64-bit if possible
+  if (x <= std::numeric_limits<int64_t>::max())
+    return semiprime_count((int64_t) x, threads, is_print);
+  else
+    return semiprime_count_OpenMP(x, threads, is_print);
+}
+
+#endif
+
+} // namespace
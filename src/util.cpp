@@ -3,7 +3,7 @@
 ///        This file contains helper functions and global variables
 ///        that are initialized with default settings.
 ///
-/// Copyright (C) 2022 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -23,6 +23,7 @@
 #include <limits>
 #include <string>
 #include <stdint.h>
+#include <time.h>
 #include <utility>
 
 using std::min;
@@ -165,6 +166,32 @@ double get_time()
   return (double) micro.count() / 1e6;
 }
 
+/// Get the time in seconds using a coarse clock with
+/// millisecond accuracy. On Linux CLOCK_MONOTONIC_COARSE is
+/// read from the vDSO without a system call and without
+/// reading the hardware timer, hence it is much cheaper than
+/// std::chrono::steady_clock. This is used for throttling
+/// the status output. Time values of get_time_coarse()
+/// must not be mixed with time values of get_time().
+/// Whether the coarse clock is available is checked only
+/// once, hence all calls use the same clock.
+///
+double get_time_coarse()
+{
+#if defined(CLOCK_MONOTONIC_COARSE)
+  struct timespec ts;
+  static const bool is_coarse = (clock_gettime(CLOCK_MONOTONIC_COARSE, &ts) == 0);
+
+  if (is_coarse)
+  {
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+  }
+#endif
+
+  return get_time();
+}
+
 void set_alpha(double alpha)
 {
   // If alpha < 1 then we compute a good
@@ -0,0 +1,111 @@
+///
+/// @file   PiTable_lookup.cpp
+/// @brief  Test the batch lookup functions PiTable::lookup() and
+///         SegmentedPiTable::lookup() against operator[]. If the
+///         CPU supports AVX512 VPOPCNTDQ this tests the AVX512
+///         code path, including batches whose size is not a
+///         multiple of 8.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <PiTable.hpp>
+#include <SegmentedPiTable.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using std::size_t;
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+template <typename PiTable>
+bool equal(const PiTable& pi, const std::vector<uint64_t>& xs)
+{
+  std::vector<int64_t> out(xs.size());
+  pi.lookup(xs.data(), xs.size(), out.data());
+
+  for (size_t i = 0; i < xs.size(); i++)
+    if (out[i] != pi[xs[i]])
+      return false;
+
+  return true;
+}
+
+int main()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  {
+    uint64_t max_x = 10000000;
+    int threads = 1;
+    PiTable pi(max_x, threads);
+
+    // Tiny x and all remainders of x % 240
+    for (size_t n = 0; n <= 17; n++)
+    {
+      std::vector<uint64_t> xs;
+      for (uint64_t x = 0; x < 1000; x++)
+        if (x % 17 == n || n == 17)
+          xs.push_back(x);
+
+      std::cout << "PiTable.lookup(" << xs.size() << " x values <= 1000)";
+      check(equal(pi, xs));
+    }
+
+    std::uniform_int_distribution<uint64_t> dist_x(0, max_x);
+    std::uniform_int_distribution<size_t> dist_n(0, 100);
+
+    for (int i = 0; i < 100; i++)
+    {
+      std::vector<uint64_t> xs(dist_n(gen));
+      for (uint64_t& x : xs)
+        x = dist_x(gen);
+
+      std::cout << "PiTable.lookup(" << xs.size() << " random x values)";
+      check(equal(pi, xs));
+    }
+  }
+
+  {
+    SegmentedPiTable pi;
+    uint64_t segment_size = SegmentedPiTable::get_segment_size(1 << 16);
+    uint64_t segments = 10;
+    std::uniform_int_distribution<size_t> dist_n(0, 100);
+
+    for (uint64_t low = 0; low < segment_size * segments; low += segment_size)
+    {
+      uint64_t high = low + segment_size;
+      pi.init(low, high);
+      std::uniform_int_distribution<uint64_t> dist_x(low, high - 1);
+
+      for (int i = 0; i < 10; i++)
+      {
+        std::vector<uint64_t> xs(dist_n(gen));
+        for (uint64_t& x : xs)
+          x = dist_x(gen);
+
+        std::cout << "SegmentedPiTable.lookup(" << xs.size() << " random x values in [" << low << ", " << high << "[)";
+        check(equal(pi, xs));
+      }
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+///
+/// @file   SegmentedPrimes.cpp
+/// @brief  Test the SegmentedPrimes class (compressed primes
+///         array) against generate_primes(max).
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <SegmentedPrimes.hpp>
+#include <generate.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+template <typename T>
+bool equal(const SegmentedPrimes<T>& primes, int64_t max)
+{
+  auto expected = generate_primes<int64_t>(max);
+
+  if (primes.size() != expected.size())
+    return false;
+
+  for (std::size_t i = 0; i < expected.size(); i++)
+    if ((int64_t) primes[i] != expected[i])
+      return false;
+
+  return true;
+}
+
+int main()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  for (int64_t max = 0; max < 1000; max++)
+  {
+    SegmentedPrimes<int64_t> primes(max, 1);
+    std::cout << "SegmentedPrimes(" << max << ", 1)";
+    check(equal(primes, max));
+  }
+
+  // Multiple blocks of 2^16 primes and multiple chunks
+  std::uniform_int_distribution<int64_t> dist(200000000, 300000000);
+
+  for (int threads = 1; threads <= 4; threads++)
+  {
+    int64_t max = dist(gen);
+    SegmentedPrimes<uint64_t> primes(max, threads);
+    std::cout << "SegmentedPrimes(" << max << ", " << threads << ")";
+    check(equal(primes, max));
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+///
+/// @file   StatusS2.cpp
+/// @brief  Test the time-linear progress model of StatusS2.
+///         We feed synthetic work units whose runtime is the
+///         sum of a special leaf cost (density ~ 1 / n) and a
+///         sieving cost (proportional to the interval size)
+///         with some random noise. The estimated percentage
+///         must be roughly linear in time and the estimated
+///         remaining time must be close to the actual
+///         remaining time.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <StatusS2.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// Synthetic runtime of sieving [low, high[
+double cost(int64_t low, int64_t high, int64_t limit)
+{
+  double s = std::sqrt((double) limit);
+  double leaf_cost = std::log((high + s) / (low + s));
+  double sieve_cost = (high - low) * 1e-9;
+  return leaf_cost + sieve_cost;
+}
+
+int main()
+{
+  int64_t limit = (int64_t) 1e10;
+  int threads = 4;
+
+  // Work units grow like in LoadBalancerS2
+  std::vector<int64_t> units;
+  int64_t unit_size = limit / 100000;
+  for (int64_t low = 0; low < limit; low += unit_size)
+  {
+    units.push_back(low);
+    unit_size = std::min(unit_size + unit_size / 10, limit / 50);
+  }
+  units.push_back(limit);
+
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<double> noise(0.9, 1.1);
+  std::vector<double> secs(units.size() - 1);
+  double total_secs = 0;
+
+  for (std::size_t i = 0; i + 1 < units.size(); i++)
+  {
+    secs[i] = cost(units[i], units[i + 1], limit) * noise(gen);
+    total_secs += secs[i];
+  }
+
+  StatusS2 status(limit);
+  status.set_threads(threads);
+  double done_secs = 0;
+  double max_error = 0;
+  double max_eta_error = 0;
+
+  for (std::size_t i = 0; i + 1 < units.size(); i++)
+  {
+    int64_t low = units[i];
+    int64_t high = units[i + 1];
+
+    if (i < 7)
+    {
+      std::cout << "Unit " << i << ": not calibrated";
+      check(!status.is_calibrated() &&
+            status.getRemainingSecs(low, limit) == -1);
+    }
+
+    status.add_work(low, high - low, limit, secs[i]);
+    done_secs += secs[i];
+
+    if (!status.is_calibrated())
+      continue;
+
+    double percent = status.getPercent(high, limit);
+    double expected = 100 * done_secs / total_secs;
+    double eta = status.getRemainingSecs(high, limit);
+    double remaining = (total_secs - done_secs) / threads;
+
+    if (eta < 0 || eta > 2 * total_secs / threads)
+    {
+      std::cout << "Unit " << i << ": invalid ETA: " << eta;
+      check(false);
+    }
+
+    // Near the start the runtime is dominated by the
+    // special leaves and the sieving cost cannot be
+    // measured, the model only becomes accurate once
+    // 1% of the sieve interval has been processed.
+    if (high < limit / 100)
+      continue;
+
+    max_error = std::max(max_error, std::abs(percent - expected));
+
+    // The ETA of the last few percent is not very
+    // accurate, but it is also not very important.
+    if (expected < 90)
+      max_eta_error = std::max(max_eta_error, std::abs(eta - remaining) / remaining);
+  }
+
+  std::cout << "Work units: " << units.size() - 1;
+  check(units.size() > 100);
+
+  std::cout << "Max error of time-linear percentage: " << max_error << "%";
+  check(max_error < 6);
+
+  std::cout << "Max relative error of remaining time: " << max_eta_error;
+  check(max_eta_error < 0.25);
+
+  {
+    double percent = status.getPercent(limit, limit);
+    std::cout << "Percentage at the end: " << percent << "%";
+    check(percent == 100);
+  }
+
+  {
+    double eta = status.getRemainingSecs(limit, limit);
+    std::cout << "Remaining time at the end: " << eta;
+    check(eta == 0);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
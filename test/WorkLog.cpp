@@ -0,0 +1,125 @@
+///
+/// @file   WorkLog.cpp
+/// @brief  Record the work units of the load balancers to a log
+///         file and replay them. The results must not change.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <WorkLog.hpp>
+#include <gourdon.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  std::string filename = "WorkLog_test.log";
+  int64_t x = (int64_t) 1e13;
+  int64_t pix = 346065536839;
+
+  set_load_balancing(LOAD_BALANCING_RECORD, filename);
+
+  {
+    int64_t res = pi_gourdon_64(x, 4);
+    std::cout << "record: pi_gourdon_64(" << x << ") = " << res;
+    check(res == pix);
+  }
+
+  {
+    int64_t res = pi_deleglise_rivat_64(x, 4);
+    std::cout << "record: pi_deleglise_rivat_64(" << x << ") = " << res;
+    check(res == pix);
+  }
+
+  {
+    // LoadBalancerAC, LoadBalancerS2 (D), LoadBalancerS2 (S2_hard)
+    std::ifstream file(filename);
+    std::string line;
+    int blocks = 0;
+    while (std::getline(file, line))
+      if (line.find("LoadBalancer") == 0)
+        blocks++;
+    std::cout << "Number of recorded load balancers = " << blocks;
+    check(blocks == 3);
+  }
+
+  // Replay the same work units using a different
+  // number of threads, the results must not change.
+  for (int threads = 1; threads <= 3; threads++)
+  {
+    set_load_balancing(LOAD_BALANCING_REPLAY, filename);
+
+    {
+      int64_t res = pi_gourdon_64(x, threads);
+      std::cout << "replay: pi_gourdon_64(" << x << ", threads = " << threads << ") = " << res;
+      check(res == pix);
+    }
+
+    {
+      int64_t res = pi_deleglise_rivat_64(x, threads);
+      std::cout << "replay: pi_deleglise_rivat_64(" << x << ", threads = " << threads << ") = " << res;
+      check(res == pix);
+    }
+  }
+
+  {
+    // Replaying the log of a different x must fail
+    set_load_balancing(LOAD_BALANCING_REPLAY, filename);
+    bool error = false;
+
+    try
+    {
+      pi_gourdon_64(x + 1000000, 2);
+    }
+    catch (primecount_error&)
+    {
+      error = true;
+    }
+
+    std::cout << "replay: log of different x rejected";
+    check(error);
+  }
+
+  {
+    bool error = false;
+
+    try
+    {
+      set_load_balancing(LOAD_BALANCING_RECORD, "non-existent-dir/WorkLog_test.log");
+    }
+    catch (primecount_error&)
+    {
+      error = true;
+    }
+
+    std::cout << "record: invalid log file rejected";
+    check(error);
+  }
+
+  set_load_balancing(LOAD_BALANCING_ADAPTIVE);
+  std::remove(filename.c_str());
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -2,7 +2,7 @@
 /// @file   api_c.c
 /// @brief  Test primecount's C API.
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -97,6 +97,100 @@ int main(void)
   printf("primecount_pi_str(%s) = %s", in, out);
   check(strcmp(out, "37607912018") == 0);
 
+  n = (int64_t) 1e9;
+  int64_t q = 4;
+  a = 3;
+  res = primecount_pi_mod(n, q, a);
+  printf("primecount_pi_mod(%"PRId64", %"PRId64", %"PRId64") = %"PRId64, n, q, a, res);
+  check(res == 25424042);
+
+  a = 1;
+  res = primecount_pi_mod(n, q, a);
+  printf("primecount_pi_mod(%"PRId64", %"PRId64", %"PRId64") = %"PRId64, n, q, a, res);
+  check(res == 25423491);
+
+  // q = 0 is an error and should hence return -1
+  q = 0;
+  res = primecount_pi_mod(n, q, a);
+  printf("primecount_pi_mod(%"PRId64", %"PRId64", %"PRId64") = %"PRId64, n, q, a, res);
+  check(res == -1);
+
+  n = (int64_t) 1e10;
+  res = primecount_semiprime_count(n);
+  printf("primecount_semiprime_count(%"PRId64") = %"PRId64, n, res);
+  check(res == 1493776443);
+
+  n = -1;
+  res = primecount_semiprime_count(n);
+  printf("primecount_semiprime_count(%"PRId64") = %"PRId64, n, res);
+  check(res == 0);
+
+  in = "10^12";
+  int len = primecount_semiprime_count_str(in, out, sizeof(out));
+  printf("primecount_semiprime_count_str(%s) = %s", in, out);
+  check(len == 12 && strcmp(out, "131126017178") == 0);
+
+  // Invalid x should return -1
+  in = "abc";
+  len = primecount_semiprime_count_str(in, out, sizeof(out));
+  printf("primecount_semiprime_count_str(%s) = %d", in, len);
+  check(len == -1 && strcmp(out, "") == 0);
+
+  // res buffer too small should return -1
+  in = "10^12";
+  len = primecount_semiprime_count_str(in, out, 5);
+  printf("primecount_semiprime_count_str(%s, len = 5) = %d", in, len);
+  check(len == -1);
+
+  n = (int64_t) 1e10;
+  res = primecount_mertens(n);
+  printf("primecount_mertens(%"PRId64") = %"PRId64, n, res);
+  check(res == -33722);
+
+  in = "10^12";
+  len = primecount_mertens_str(in, out, sizeof(out));
+  printf("primecount_mertens_str(%s) = %s", in, out);
+  check(len == 5 && strcmp(out, "62366") == 0);
+
+  // x > 10^27 is an error and should hence return -1
+  in = "10^28";
+  len = primecount_mertens_str(in, out, sizeof(out));
+  printf("primecount_mertens_str(%s) = %d", in, len);
+  check(len == -1 && strcmp(out, "") == 0);
+
+  in = "abc";
+  len = primecount_mertens_str(in, out, sizeof(out));
+  printf("primecount_mertens_str(%s) = %d", in, len);
+  check(len == -1 && strcmp(out, "") == 0);
+
+  in = "10^12";
+  len = primecount_prime_sum_str(in, out, sizeof(out));
+  printf("primecount_prime_sum_str(%s) = %s", in, out);
+  check(len == 23 && strcmp(out, "18435588552550705911377") == 0);
+
+  in = "-1";
+  len = primecount_prime_sum_str(in, out, sizeof(out));
+  printf("primecount_prime_sum_str(%s) = %s", in, out);
+  check(len == 1 && strcmp(out, "0") == 0);
+
+  // x > 1.2 * 10^20 should return -1
+  in = "10^21";
+  len = primecount_prime_sum_str(in, out, sizeof(out));
+  printf("primecount_prime_sum_str(%s) = %d", in, len);
+  check(len == -1 && strcmp(out, "") == 0);
+
+  // Invalid x should return -1
+  in = "abc";
+  len = primecount_prime_sum_str(in, out, sizeof(out));
+  printf("primecount_prime_sum_str(%s) = %d", in, len);
+  check(len == -1 && strcmp(out, "") == 0);
+
+  // res buffer too small should return -1
+  in = "10^12";
+  len = primecount_prime_sum_str(in, out, 5);
+  printf("primecount_prime_sum_str(%s, len = 5) = %d", in, len);
+  check(len == -1);
+
   printf("\n");
   printf("All tests passed successfully!\n");
 
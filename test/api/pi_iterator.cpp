@@ -0,0 +1,104 @@
+///
+/// @file   pi_iterator.cpp
+/// @brief  Test the pi_iterator class. pi_iterator uses
+///         pi(x) under the hood for large jumps, hence this
+///         test is located in the test/api directory.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+
+using namespace primecount;
+
+void check_equal(int64_t x,
+                 int64_t res1,
+                 int64_t res2)
+{
+  bool OK = (res1 == res2);
+  std::cout << "pi_iterator.advance_to(" << x << ") = " << res1 << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int64_t pi_primesieve(int64_t x)
+{
+  return (x < 2) ? 0 : primesieve::count_primes(0, x);
+}
+
+int main()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // Tiny x, forward and reverse
+  {
+    pi_iterator it(-10);
+    for (int64_t x = -10; x <= 1000; x++)
+      check_equal(x, it.advance_to(x), pi_primesieve(x));
+    for (int64_t x = 1000; x >= -10; x--)
+      check_equal(x, it.advance_to(x), pi_primesieve(x));
+  }
+
+  // Random small steps, forward
+  {
+    std::uniform_int_distribution<int64_t> dist(0, 1000000);
+    int64_t x = (int64_t) 1e10 + dist(gen);
+    pi_iterator it(x);
+    check_equal(x, it.get_pi(), pi(x));
+    int64_t pix = it.get_pi();
+    int64_t prev_x = x;
+
+    for (int i = 0; i < 100; i++)
+    {
+      x += dist(gen);
+      pix += primesieve::count_primes(prev_x + 1, x);
+      prev_x = x;
+      check_equal(x, it.advance_to(x), pix);
+    }
+  }
+
+  // Random small steps, reverse
+  {
+    std::uniform_int_distribution<int64_t> dist(0, 1000000);
+    int64_t x = (int64_t) 1e11 + dist(gen);
+    pi_iterator it(x, 2);
+    int64_t pix = pi(x);
+    check_equal(x, it.get_pi(), pix);
+    int64_t prev_x = x;
+
+    for (int i = 0; i < 100; i++)
+    {
+      x -= dist(gen);
+      pix -= primesieve::count_primes(x + 1, prev_x);
+      prev_x = x;
+      check_equal(x, it.advance_to(x), pix);
+    }
+  }
+
+  // Random large jumps, pi(x) is computed from scratch
+  {
+    std::uniform_int_distribution<int64_t> dist(0, (int64_t) 1e12);
+    pi_iterator it;
+
+    for (int i = 0; i < 20; i++)
+    {
+      int64_t x = dist(gen);
+      check_equal(x, it.advance_to(x), pi(x));
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+///
+/// @file   pi_store.cpp
+/// @brief  Test the pi(x) store. Records that are appended to the
+///         store file by another process must be used by pi(x)
+///         and nth_prime(n) and an incomplete record at the end
+///         of the file (crashed process) must be ignored.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace primecount;
+
+const std::string filename = "pi_store_test.txt";
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+  {
+    set_pi_store("");
+    std::remove(filename.c_str());
+    std::exit(1);
+  }
+}
+
+std::string read_file()
+{
+  std::ifstream file(filename);
+  std::ostringstream oss;
+  oss << file.rdbuf();
+  return oss.str();
+}
+
+/// Simulates another process appending to the store
+void append(const std::string& str)
+{
+  std::ofstream file(filename, std::ios::app);
+  file << str;
+}
+
+int main()
+{
+  std::remove(filename.c_str());
+  set_pi_store(filename);
+
+  {
+    int64_t x = 100000000000ll;
+    int64_t res = pi(x);
+    std::cout << "pi(" << x << ") = " << res;
+    check(res == 4118054813ll);
+
+    std::string record = "100000000000 4118054813 gourdon";
+    std::cout << "Store contains: " << record;
+    check(read_file().find(record) != std::string::npos);
+  }
+
+  {
+    // pi(x) must be looked up in the store
+    append("20000000000 123 test\n");
+    int64_t x = 20000000000ll;
+    int64_t res = pi(x);
+    std::cout << "pi(" << x << ") = " << res;
+    check(res == 123);
+  }
+
+  {
+    // Incomplete record of a crashed process
+    append("30000000000 99");
+    int64_t x = 30000000000ll;
+    int64_t res = pi(x);
+    std::cout << "pi(" << x << ") = " << res;
+    check(res == 1300005926ll);
+
+    std::cout << "Incomplete record removed";
+    check(read_file().find("30000000000 99\n") == std::string::npos);
+
+    std::string record = "\n30000000000 1300005926 gourdon";
+    std::cout << "Store contains: " << record.substr(1);
+    check(read_file().find(record) != std::string::npos);
+  }
+
+  {
+    int64_t n = 500000000;
+    int64_t res = nth_prime(n);
+    std::cout << "nth_prime(" << n << ") = " << res;
+    check(res == 11037271757ll);
+
+    std::string record = "11037271757 500000000 nth_prime";
+    std::cout << "Store contains: " << record;
+    check(read_file().find(record) != std::string::npos);
+
+    // nth_prime(n) must be looked up in the store
+    append("10000000019 7777 nth_prime\n");
+    n = 7777;
+    res = nth_prime(n);
+    std::cout << "nth_prime(" << n << ") = " << res;
+    check(res == 10000000019ll);
+  }
+
+  {
+    // Records must be read from the file
+    set_pi_store("");
+    set_pi_store(filename);
+    int64_t x = 20000000000ll;
+    int64_t res = pi(x);
+    std::cout << "pi(" << x << ") = " << res;
+    check(res == 123);
+
+    // Store disabled
+    set_pi_store("");
+    res = pi(x);
+    std::cout << "pi(" << x << ") = " << res;
+    check(res == 882206716);
+  }
+
+  std::remove(filename.c_str());
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
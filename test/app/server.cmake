@@ -0,0 +1,24 @@
+# Usage: cmake -DPRIMECOUNT=<binary> -DINPUT=<file> -P server.cmake
+
+execute_process(COMMAND ${PRIMECOUNT} --stdin
+                INPUT_FILE ${INPUT}
+                OUTPUT_VARIABLE output
+                ERROR_VARIABLE error
+                RESULT_VARIABLE result)
+
+message("stdout:\n${output}")
+message("stderr:\n${error}")
+
+# The invalid line is reported on stderr,
+# the following lines are still processed.
+set(expected "455052511\n4118054813\n82025\n")
+
+if(NOT output STREQUAL expected)
+    message(FATAL_ERROR "Unexpected output, expected:\n${expected}")
+endif()
+if(NOT result EQUAL 1)
+    message(FATAL_ERROR "Unexpected exit code: ${result}")
+endif()
+if(NOT error MATCHES "^primecount: ")
+    message(FATAL_ERROR "Missing error message for invalid line")
+endif()
@@ -0,0 +1,76 @@
+///
+/// @file   backup_work_units.cpp
+/// @brief  Force LoadBalancerS2 to run backup copies of all
+///         unfinished work units at the end of S2_hard and D.
+///         The first copy to finish wins and the other copy is
+///         cancelled, the results must not change.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <LoadBalancerS2.hpp>
+#include <gourdon.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  // Back up every unfinished work
+  // unit without waiting.
+  set_backup_threshold(0);
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int64_t> dist(1, (int64_t) 1e12);
+
+  for (int i = 0; i < 6; i++)
+  {
+    int threads = 2 + i % 3;
+    int64_t x = dist(gen);
+    int64_t res1 = pi_legendre(x, 1);
+
+    {
+      int64_t res2 = pi_deleglise_rivat_64(x, threads);
+      std::cout << "pi_deleglise_rivat_64(" << x << ", threads = " << threads << ") = " << res2;
+      check(res1 == res2);
+    }
+
+    {
+      int64_t res2 = pi_gourdon_64(x, threads);
+      std::cout << "pi_gourdon_64(" << x << ", threads = " << threads << ") = " << res2;
+      check(res1 == res2);
+    }
+  }
+
+  {
+    int64_t x = (int64_t) 1e10;
+    int64_t res = mertens(x, 4);
+    std::cout << "mertens(" << x << ", threads = 4) = " << res;
+    check(res == -33722);
+  }
+
+  std::cout << "Number of backup work units: " << get_backup_units();
+  check(get_backup_units() > 0);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
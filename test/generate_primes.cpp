@@ -0,0 +1,92 @@
+///
+/// @file   generate_primes.cpp
+/// @brief  Test the parallel generate_primes(max, threads) and
+///         generate_n_primes(n, threads) functions.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <generate.hpp>
+#include <primesieve.hpp>
+#include <Vector.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+template <typename T>
+bool equal(const Vector<T>& primes, const std::vector<uint64_t>& expected)
+{
+  if (primes.size() != expected.size() + 1 || primes[0] != 0)
+    return false;
+
+  for (std::size_t i = 0; i < expected.size(); i++)
+    if ((uint64_t) primes[i + 1] != expected[i])
+      return false;
+
+  return true;
+}
+
+int main()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+
+  // Small inputs use the single-threaded code path
+  for (int64_t max = 0; max < 1000; max++)
+  {
+    std::vector<uint64_t> expected;
+    primesieve::generate_primes(max, &expected);
+    auto primes = generate_primes<int32_t>(max, 4);
+    std::cout << "generate_primes(" << max << ", 4)";
+    check(equal(primes, expected));
+  }
+
+  for (int64_t n = 0; n < 1000; n++)
+  {
+    std::vector<uint64_t> expected;
+    primesieve::generate_n_primes(n, &expected);
+    auto primes = generate_n_primes<int32_t>(n, 4);
+    std::cout << "generate_n_primes(" << n << ", 4)";
+    check(equal(primes, expected));
+  }
+
+  // Large inputs use the parallel code path
+  std::uniform_int_distribution<int64_t> dist(200000000, 300000000);
+
+  for (int threads = 2; threads <= 4; threads++)
+  {
+    int64_t max = dist(gen);
+    std::vector<uint64_t> expected;
+    primesieve::generate_primes(max, &expected);
+    auto primes = generate_primes<uint32_t>(max, threads);
+    std::cout << "generate_primes(" << max << ", " << threads << ")";
+    check(equal(primes, expected));
+
+    int64_t n = dist(gen) / 20;
+    expected.clear();
+    primesieve::generate_n_primes(n, &expected);
+    auto n_primes = generate_n_primes<int64_t>(n, threads);
+    std::cout << "generate_n_primes(" << n << ", " << threads << ")";
+    check(equal(n_primes, expected));
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
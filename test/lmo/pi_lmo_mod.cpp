@@ -0,0 +1,146 @@
+///
+/// @file   pi_lmo_mod.cpp
+/// @brief  Test the pi_lmo_mod(x, q, a) function which counts the
+///         primes <= x with p ≡ a (mod q).
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <generate.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = get_num_threads();
+  int64_t max_x = 10000000;
+  auto primes = generate_primes<int64_t>(max_x);
+
+  // Count the primes <= x with p ≡ a (mod q)
+  auto pi_mod = [&](int64_t x, int64_t q, int64_t a)
+  {
+    int64_t count = 0;
+    for (std::size_t i = 1; i < primes.size() && primes[i] <= x; i++)
+      count += (primes[i] % q == a);
+    return count;
+  };
+
+  {
+    int64_t x = -1;
+    int64_t res = pi_lmo_mod(x, 3, 1, threads);
+    std::cout << "pi_lmo_mod(" << x << ", 3, 1) = " << res;
+    check(res == 0);
+  }
+
+  for (int64_t x = 0; x <= 300; x++)
+  {
+    for (int64_t q = 1; q <= 12; q++)
+    {
+      for (int64_t a = 0; a < q; a++)
+      {
+        int64_t res1 = pi_lmo_mod(x, q, a, threads);
+        int64_t res2 = pi_mod(x, q, a);
+        std::cout << "pi_lmo_mod(" << x << ", " << q << ", " << a << ") = " << res1;
+        check(res1 == res2);
+      }
+    }
+  }
+
+  {
+    // a is reduced modulo q
+    int64_t x = 1000000;
+    int64_t res1 = pi_lmo_mod(x, 10, -1, threads);
+    int64_t res2 = pi_mod(x, 10, 9);
+    std::cout << "pi_lmo_mod(" << x << ", 10, -1) = " << res1;
+    check(res1 == res2);
+  }
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int64_t> dist_x(0, max_x);
+  std::uniform_int_distribution<int64_t> dist_q(1, 100);
+
+  for (int i = 0; i < 200; i++)
+  {
+    int64_t x = dist_x(gen);
+    int64_t q = dist_q(gen);
+    std::uniform_int_distribution<int64_t> dist_a(0, q - 1);
+    int64_t a = dist_a(gen);
+    int64_t res1 = pi_lmo_mod(x, q, a, threads);
+    int64_t res2 = pi_mod(x, q, a);
+    std::cout << "pi_lmo_mod(" << x << ", " << q << ", " << a << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  {
+    // The sum over all residue classes is pi(x)
+    int64_t x = dist_x(gen);
+    int64_t q = 30;
+    int64_t sum = 0;
+    for (int64_t a = 0; a < q; a++)
+      sum += pi_lmo_mod(x, q, a, threads);
+    std::cout << "sum pi_lmo_mod(" << x << ", " << q << ", a) = " << sum;
+    check(sum == pi_mod(x, 1, 0));
+  }
+
+  {
+    // The work units are combined in ascending order,
+    // the result must not depend on the number of threads.
+    std::uniform_int_distribution<int64_t> dist_x2((int64_t) 1e10, (int64_t) 1e11);
+    int64_t x = dist_x2(gen);
+    int64_t q = dist_q(gen);
+    int64_t a = 1;
+    int64_t res1 = pi_lmo_mod(x, q, a, 1);
+
+    for (int t = 2; t <= 8; t *= 2)
+    {
+      int64_t res2 = pi_lmo_mod(x, q, a, t);
+      std::cout << "pi_lmo_mod(" << x << ", " << q << ", " << a << ", threads = " << t << ") = " << res2;
+      check(res1 == res2);
+    }
+  }
+
+  {
+    // pi(10^11) = sum of pi(10^11; 4, a)
+    int64_t x = (int64_t) 1e11;
+    int64_t sum = 0;
+    for (int64_t a = 0; a < 4; a++)
+      sum += pi_lmo_mod(x, 4, a, 4);
+    std::cout << "sum pi_lmo_mod(" << x << ", 4, a, threads = 4) = " << sum;
+    check(sum == 4118054813ll);
+  }
+
+  try
+  {
+    pi_lmo_mod(1000, 0, 0, threads);
+    std::cout << "pi_lmo_mod(1000, 0, 0)";
+    check(false);
+  }
+  catch (const primecount_error& e)
+  {
+    std::cout << "pi_lmo_mod(1000, 0, 0): " << e.what();
+    check(true);
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
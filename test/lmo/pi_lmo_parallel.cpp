@@ -2,7 +2,7 @@
 /// @file   pi_lmo_parallel.cpp
 /// @brief  Test the pi_lmo_parallel(x) function.
 ///
-/// Copyright (C) 2023 Kim Walisch, <kim.walisch@gmail.com>
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
 ///
 /// This file is distributed under the BSD License. See the COPYING
 /// file in the top level directory.
@@ -11,6 +11,8 @@
 #include <primecount.hpp>
 #include <primecount-internal.hpp>
 #include <PiTable.hpp>
+#include <gourdon.hpp>
+#include <int128_t.hpp>
 
 #include <stdint.h>
 #include <iostream>
@@ -66,6 +68,53 @@ int main()
     check(res == 4118054813ll);
   }
 
+#ifdef HAVE_INT128_T
+  // Test the 128-bit code path using small x
+  for (int64_t x = 0; x <= PiTable::max_cached(); x++)
+  {
+    int128_t res1 = pi_lmo_parallel_128(x, threads);
+    int64_t res2 = pi_cache(x);
+    std::cout << "pi_lmo_parallel_128(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  for (int i = 0; i < 100; i++)
+  {
+    int64_t x = dist(gen);
+    int128_t res1 = pi_lmo_parallel_128(x, threads);
+    int64_t res2 = pi_meissel(x, threads);
+    std::cout << "pi_lmo_parallel_128(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  {
+    std::uniform_int_distribution<int64_t> dist2((int64_t) 1e11, (int64_t) 1e12);
+    int64_t x = dist2(gen);
+    int128_t res1 = pi_lmo_parallel_128(x, threads);
+    int64_t res2 = pi_gourdon_64(x, threads);
+    std::cout << "pi_lmo_parallel_128(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  {
+    // x > get_max_x() must throw an exception
+    int128_t x = ((int128_t) 1) << 120;
+    bool error = false;
+
+    try
+    {
+      pi_lmo_parallel(x, threads);
+    }
+    catch (primecount_error&)
+    {
+      error = true;
+    }
+
+    std::cout << "pi_lmo_parallel(2^120) throws primecount_error";
+    check(error);
+  }
+#endif
+
   std::cout << std::endl;
   std::cout << "All tests passed successfully!" << std::endl;
 
@@ -0,0 +1,134 @@
+///
+/// @file   prime_sum_lmo.cpp
+/// @brief  Test the prime_sum_lmo(x) function which computes
+///         the sum of the primes <= x.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <int128_t.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = get_num_threads();
+
+  {
+    int64_t x = -1;
+    maxint_t res = prime_sum_lmo(x, threads);
+    std::cout << "prime_sum_lmo(" << x << ") = " << res;
+    check(res == 0);
+  }
+
+  for (int64_t x = 0; x <= 10000; x++)
+  {
+    maxint_t res1 = prime_sum_lmo(x, threads);
+    maxint_t res2 = prime_sum_primesieve(x);
+    std::cout << "prime_sum_lmo(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int64_t> dist(0, 1 << 27);
+
+  for (int i = 0; i < 100; i++)
+  {
+    int64_t x = dist(gen);
+    maxint_t res1 = prime_sum_lmo(x, threads);
+    maxint_t res2 = prime_sum_primesieve(x);
+    std::cout << "prime_sum_lmo(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  {
+    // Sum of the primes <= 10^10
+    std::string res = prime_sum((int64_t) 1e10);
+    std::cout << "prime_sum(10^10) = " << res;
+    check(res == "2220822432581729238");
+  }
+
+#if defined(HAVE_INT128_T)
+  {
+    // Sum of the primes <= 10^11 does not fit into 64-bit
+    std::string res = prime_sum((int64_t) 1e11);
+    std::cout << "prime_sum(10^11) = " << res;
+    check(res == "201467077743744681014");
+  }
+
+  {
+    std::string res = prime_sum("10^12");
+    std::cout << "prime_sum(\"10^12\") = " << res;
+    check(res == "18435588552550705911377");
+  }
+
+  // Test the 128-bit code path using small x
+  for (int64_t x = 0; x <= 1000; x++)
+  {
+    int128_t res1 = prime_sum_lmo_128(x, threads);
+    maxint_t res2 = prime_sum_primesieve(x);
+    std::cout << "prime_sum_lmo_128(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  for (int i = 0; i < 20; i++)
+  {
+    int64_t x = dist(gen);
+    int128_t res1 = prime_sum_lmo_128(x, threads);
+    maxint_t res2 = prime_sum_lmo(x, threads);
+    std::cout << "prime_sum_lmo_128(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  {
+    std::uniform_int_distribution<int64_t> dist2((int64_t) 1e11, (int64_t) 1e12);
+    int64_t x = dist2(gen);
+    int128_t res1 = prime_sum_lmo_128(x, threads);
+    maxint_t res2 = prime_sum_lmo(x, threads);
+    std::cout << "prime_sum_lmo_128(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  {
+    // For x > 1.2 * 10^20 the prime sum does
+    // not fit into a signed 128-bit integer.
+    bool error = false;
+
+    try
+    {
+      prime_sum("120000000000000000001");
+    }
+    catch (primecount_error&)
+    {
+      error = true;
+    }
+
+    std::cout << "prime_sum(1.2 * 10^20 + 1) throws primecount_error";
+    check(error);
+  }
+#endif
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
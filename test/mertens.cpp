@@ -0,0 +1,90 @@
+///
+/// @file   mertens.cpp
+/// @brief  Test the Mertens function M(x) = \sum_{n=1}^{x} mu(n).
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <generate.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = get_num_threads();
+  int64_t max_x = 10000000;
+
+  // M[n] = \sum_{i=1}^{n} mu(i)
+  std::vector<int32_t> M(max_x + 1, 0);
+
+  {
+    auto mu = generate_moebius(max_x);
+    for (int64_t n = 1; n <= max_x; n++)
+      M[n] = M[n - 1] + mu[n];
+  }
+
+  {
+    int64_t x = -1;
+    int64_t res = mertens(x, threads);
+    std::cout << "mertens(" << x << ") = " << res;
+    check(res == 0);
+  }
+
+  for (int64_t x = 0; x <= 10000; x++)
+  {
+    int64_t res1 = mertens(x, threads);
+    int64_t res2 = M[x];
+    std::cout << "mertens(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int64_t> dist(0, max_x);
+
+  for (int i = 0; i < 200; i++)
+  {
+    int64_t x = dist(gen);
+    int64_t res1 = mertens(x, threads);
+    int64_t res2 = M[x];
+    std::cout << "mertens(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  {
+    int64_t x = (int64_t) 1e10;
+    int64_t res = mertens(x, threads);
+    std::cout << "mertens(" << x << ") = " << res;
+    check(res == -33722);
+  }
+
+  {
+    std::string res = mertens("10^11");
+    std::cout << "mertens(10^11) = " << res;
+    check(res == "-87856");
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
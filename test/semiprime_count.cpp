@@ -0,0 +1,101 @@
+///
+/// @file   semiprime_count.cpp
+/// @brief  Test the semiprime_count(x) function that counts the
+///         numbers <= x that are the product of exactly 2 prime
+///         factors.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <generate.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::size_t;
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = get_num_threads();
+  int64_t max_x = 10000000;
+
+  // semiprimes[n] = number of semiprimes <= n
+  std::vector<int32_t> semiprimes(max_x + 1, 0);
+
+  {
+    // omega[n] = number of prime factors of n
+    std::vector<uint8_t> omega(max_x + 1, 0);
+    auto primes = generate_primes<int64_t>(max_x);
+
+    for (size_t i = 1; i < primes.size(); i++)
+      for (int64_t q = primes[i]; q <= max_x; q *= primes[i])
+        for (int64_t n = q; n <= max_x; n += q)
+          omega[n]++;
+
+    for (int64_t n = 1; n <= max_x; n++)
+      semiprimes[n] = semiprimes[n - 1] + (omega[n] == 2);
+  }
+
+  {
+    int64_t x = -1;
+    int64_t res = semiprime_count(x, threads);
+    std::cout << "semiprime_count(" << x << ") = " << res;
+    check(res == 0);
+  }
+
+  for (int64_t x = 0; x <= 10000; x++)
+  {
+    int64_t res1 = semiprime_count(x, threads);
+    int64_t res2 = semiprimes[x];
+    std::cout << "semiprime_count(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<int64_t> dist(0, max_x);
+
+  for (int i = 0; i < 200; i++)
+  {
+    int64_t x = dist(gen);
+    int64_t res1 = semiprime_count(x, threads);
+    int64_t res2 = semiprimes[x];
+    std::cout << "semiprime_count(" << x << ") = " << res1;
+    check(res1 == res2);
+  }
+
+  {
+    int64_t x = (int64_t) 1e10;
+    int64_t res = semiprime_count(x, threads);
+    std::cout << "semiprime_count(" << x << ") = " << res;
+    check(res == 1493776443);
+  }
+
+  {
+    std::string res = semiprime_count("10^11");
+    std::cout << "semiprime_count(10^11) = " << res;
+    check(res == "13959990342");
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
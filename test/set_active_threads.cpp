@@ -0,0 +1,137 @@
+///
+/// @file   set_active_threads.cpp
+/// @brief  Shrink and grow the number of active threads while
+///         pi(x, threads) is running and check that the results are
+///         still correct.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <ElasticThreads.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = 4;
+  int64_t x = 10000000000000ll;
+  int64_t pix = 346065536839ll;
+
+  {
+    set_active_threads(1);
+    int64_t res = pi(x, threads);
+    std::cout << "pi(" << x << ") = " << res << " with 1 active thread";
+    check(res == pix);
+  }
+
+  {
+    // The active threads limit is modified from
+    // another thread while pi(x, threads) is running.
+    std::atomic<bool> is_done(false);
+    std::thread elastic([&]
+    {
+      int limits[] = { 1, 3, 2, 0 };
+      for (int i = 0; !is_done; i = (i + 1) % 4)
+      {
+        set_active_threads(limits[i]);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    });
+
+    for (int i = 0; i < 3; i++)
+    {
+      int64_t res = pi(x, threads);
+      std::cout << "pi(" << x << ") = " << res << " with elastic threads";
+      check(res == pix);
+    }
+
+    is_done = true;
+    elastic.join();
+  }
+
+  {
+    // Check that threads are parked while the active
+    // threads limit is 1 and that they are unparked
+    // once the limit is removed.
+    int64_t x2 = 100000000000000ll;
+    int64_t pix2 = 3204941750802ll;
+    int64_t res = 0;
+    std::atomic<bool> is_done(false);
+
+    set_active_threads(1);
+    std::thread worker([&]
+    {
+      res = pi(x2, threads);
+      is_done = true;
+    });
+
+    int max_running = 0;
+    int max_parked = 0;
+
+    while (!is_done && max_parked == 0)
+    {
+      max_running = std::max(max_running, get_running_threads());
+      max_parked = std::max(max_parked, get_parked_threads());
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::cout << "Parked threads with 1 active thread: " << max_parked;
+    check(max_parked > 0);
+    std::cout << "Max running threads with 1 active thread: " << max_running;
+    check(max_running <= 1);
+
+    set_active_threads(0);
+    bool is_unparked = false;
+    max_running = 0;
+
+    while (!is_done)
+    {
+      int running = get_running_threads();
+      if (get_parked_threads() == 0)
+        is_unparked = true;
+      if (is_unparked)
+        max_running = std::max(max_running, running);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    worker.join();
+
+    std::cout << "Parked threads without limit: " << get_parked_threads();
+    check(is_unparked && get_parked_threads() == 0);
+    std::cout << "Max running threads without limit: " << max_running;
+    check(max_running > 1 && max_running <= threads);
+    std::cout << "pi(" << x2 << ") = " << res;
+    check(res == pix2);
+    std::cout << "Running threads after pi(x): " << get_running_threads();
+    check(get_running_threads() == 0);
+  }
+
+  set_active_threads(0);
+  std::cout << "get_active_threads() = " << get_active_threads();
+  check(get_active_threads() == 0);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+///
+/// @file   sieve3.cpp
+/// @brief  Test Sieve::cross_off_count(prime) and Sieve::count()
+///         using multiple segments, this also tests that the
+///         wheel state of the sieving primes (dense and sparse)
+///         is correctly carried over to the next segment.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <Sieve.hpp>
+#include <generate.hpp>
+#include <imath.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <random>
+
+using std::size_t;
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> dist(1, 100000);
+
+  uint64_t low = dist(gen) * 30;
+  uint64_t segment_size = Sieve::get_segment_size(dist(gen) * 4);
+  uint64_t segments = 5;
+  uint64_t high = low + segment_size * segments;
+  uint64_t c = 3;
+
+  auto primes = generate_primes<uint64_t>(isqrt(high));
+  std::vector<char> sieve2(high - low, 1);
+  Sieve sieve(low, segment_size, primes.size());
+
+  // Sieve the first c primes
+  for (size_t i = 1; i <= c; i++)
+    for (uint64_t j = ceil_div(low, primes[i]) * primes[i]; j < high; j += primes[i])
+      sieve2[j - low] = 0;
+
+  for (uint64_t s = 0; s < segments; s++)
+  {
+    uint64_t seg_low = low + segment_size * s;
+    uint64_t seg_high = seg_low + segment_size;
+    sieve.pre_sieve(primes, c, seg_low, seg_high);
+
+    for (size_t i = c + 1; i < primes.size(); i++)
+    {
+      uint64_t prime = primes[i];
+      uint64_t prev_count = sieve.get_total_count();
+      sieve.cross_off_count(prime, i);
+      uint64_t cnt1 = prev_count - sieve.get_total_count();
+      uint64_t cnt2 = 0;
+
+      for (uint64_t j = ceil_div(seg_low, prime) * prime; j < seg_high; j += prime)
+      {
+        cnt2 += sieve2[j - low];
+        sieve2[j - low] = 0;
+      }
+
+      uint64_t total1 = sieve.count(seg_high - seg_low - 1);
+      uint64_t total2 = 0;
+
+      for (uint64_t j = seg_low; j < seg_high; j++)
+        total2 += sieve2[j - low];
+
+      std::cout << "[" << seg_low << ", " << seg_high << "[ cross_off_count(" << prime << ") = " << cnt1;
+      check(cnt1 == cnt2 && total1 == total2);
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
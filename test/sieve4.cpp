@@ -0,0 +1,107 @@
+///
+/// @file   sieve4.cpp
+/// @brief  Test Sieve::add_primes() near 2^52. Below 2^52 the
+///         first multiples of a batch of sieving primes are
+///         computed using double precision divisions, above 2^52
+///         using 64-bit integer divisions. The results must be
+///         identical to adding the sieving primes one by one.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <Sieve.hpp>
+#include <generate.hpp>
+#include <imath.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <random>
+
+using std::size_t;
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  std::random_device rd;
+  std::mt19937 gen(rd());
+  std::uniform_int_distribution<uint64_t> dist(1, 100000);
+
+  uint64_t max_prime = 1000000;
+  auto primes = generate_primes<uint64_t>(max_prime);
+  uint64_t c = 3;
+
+  // 1st low < 2^52, 2nd low > 2^52
+  uint64_t lows[2];
+  lows[0] = ((1ull << 52) / 30 - dist(gen)) * 30;
+  lows[1] = ((1ull << 52) / 30 + dist(gen)) * 30;
+
+  for (uint64_t low : lows)
+  {
+    uint64_t segment_size = Sieve::get_segment_size(dist(gen) * 4);
+    uint64_t segments = 3;
+    uint64_t high = low + segment_size * segments;
+    std::vector<char> sieve3(high - low, 1);
+
+    // sieve1 adds the sieving primes in batches,
+    // sieve2 adds them one by one.
+    Sieve sieve1(low, segment_size, primes.size());
+    Sieve sieve2(low, segment_size, primes.size());
+    sieve1.add_primes(primes, primes.size() - 1);
+
+    // Sieve the first c primes
+    for (size_t i = 1; i <= c; i++)
+      for (uint64_t j = ceil_div(low, primes[i]) * primes[i]; j < high; j += primes[i])
+        sieve3[j - low] = 0;
+
+    for (uint64_t s = 0; s < segments; s++)
+    {
+      uint64_t seg_low = low + segment_size * s;
+      uint64_t seg_high = seg_low + segment_size;
+      sieve1.pre_sieve(primes, c, seg_low, seg_high);
+      sieve2.pre_sieve(primes, c, seg_low, seg_high);
+      bool is_equal = true;
+
+      for (size_t i = c + 1; i < primes.size(); i++)
+      {
+        uint64_t prime = primes[i];
+        uint64_t prev_count1 = sieve1.get_total_count();
+        uint64_t prev_count2 = sieve2.get_total_count();
+        sieve1.cross_off_count(prime, i);
+        sieve2.cross_off_count(prime, i);
+        uint64_t cnt1 = prev_count1 - sieve1.get_total_count();
+        uint64_t cnt2 = prev_count2 - sieve2.get_total_count();
+        is_equal &= (cnt1 == cnt2);
+
+        for (uint64_t j = ceil_div(seg_low, prime) * prime; j < seg_high; j += prime)
+          sieve3[j - low] = 0;
+      }
+
+      uint64_t total1 = sieve1.count(seg_high - seg_low - 1);
+      uint64_t total2 = sieve2.count(seg_high - seg_low - 1);
+      uint64_t total3 = 0;
+
+      for (uint64_t j = seg_low; j < seg_high; j++)
+        total3 += sieve3[j - low];
+
+      std::cout << "[" << seg_low << ", " << seg_high << "[ count = " << total1;
+      check(is_equal && total1 == total2 && total1 == total3);
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
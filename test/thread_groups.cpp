@@ -0,0 +1,149 @@
+///
+/// @file   thread_groups.cpp
+/// @brief  Test the two-level load balancing where the threads
+///         are partitioned into groups that fetch chunks of work
+///         and steal work units from each other. Checks that
+///         the load balancers actually hand out chunks of more
+///         than one work unit when thread groups are used.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <ThreadGroups.hpp>
+#include <gourdon.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+/// With thread groups of 2 or more threads the load
+/// balancers hand out chunks of more than one work unit.
+/// Groups of 1 thread fetch a single work unit at a time.
+///
+void check_chunks(int64_t chunks, int threads_per_group, int threads)
+{
+  int64_t new_chunks = get_group_chunks() - chunks;
+  std::cout << "   chunks = " << new_chunks;
+
+  if (threads_per_group > 1 &&
+      threads_per_group < threads)
+    check(new_chunks > 0);
+  else
+    check(new_chunks == 0);
+}
+
+int main()
+{
+  int threads = 8;
+
+  {
+    set_threads_per_group(3);
+    ThreadGroups thread_groups;
+    thread_groups.init(threads);
+    std::cout << "ThreadGroups(threads = 8, threads_per_group = 3).size() = " << thread_groups.size();
+    check(thread_groups.size() == 3 &&
+          thread_groups.threads(0) == 3 &&
+          thread_groups.threads(1) == 3 &&
+          thread_groups.threads(2) == 2);
+
+    thread_groups.init(threads, false);
+    std::cout << "ThreadGroups(threads = 8, disabled).size() = " << thread_groups.size();
+    check(thread_groups.size() == 1 &&
+          thread_groups.threads(0) == threads);
+  }
+
+  {
+    // Units of size 3: [0, 3[, [3, 6[, [6, 9[, [9, 10[
+    GroupChunk chunk;
+    chunk.assign(0, 10, 3);
+    int64_t low1 = 0, high1 = 0, low2 = 0, high2 = 0;
+    int64_t low3 = 0, high3 = 0, low4 = 0, high4 = 0;
+    bool ok = chunk.pop_front(low1, high1) &&
+              chunk.pop_back(low2, high2) &&
+              chunk.pop_back(low3, high3) &&
+              chunk.pop_front(low4, high4);
+    std::cout << "GroupChunk [0, 10[ split into units of size 3";
+    check(ok && chunk.empty() &&
+          low1 == 0 && high1 == 3 &&
+          low2 == 9 && high2 == 10 &&
+          low3 == 6 && high3 == 9 &&
+          low4 == 3 && high4 == 6 &&
+          !chunk.pop_front(low1, high1) &&
+          !chunk.pop_back(low1, high1));
+  }
+
+  {
+    // Group 0 steals the last unit of group 2,
+    // group 1 has no work left.
+    ThreadGroup groups[3];
+    groups[2].chunk.assign(100, 120, 8);
+    int64_t low = 0, high = 0;
+    bool ok = steal_unit(groups, 3, 0, low, high);
+    std::cout << "steal_unit()";
+    check(ok);
+    std::cout << "steal_unit() = [" << low << ", " << high << "[";
+    check(low == 116 && high == 120 &&
+          groups[2].chunk.high == 116);
+  }
+
+  for (int threads_per_group : { 1, 2, 3, threads })
+  {
+    set_threads_per_group(threads_per_group);
+    std::cout << "threads_per_group = " << threads_per_group << std::endl;
+
+    {
+      int64_t x = (int64_t) 1e14;
+      int64_t chunks = get_group_chunks();
+      int64_t res = pi_gourdon_64(x, threads);
+      std::cout << "pi_gourdon_64(" << x << ") = " << res;
+      check(res == 3204941750802);
+      check_chunks(chunks, threads_per_group, threads);
+    }
+
+    {
+      int64_t x = (int64_t) 1e14;
+      int64_t chunks = get_group_chunks();
+      int64_t res = pi_deleglise_rivat_64(x, threads);
+      std::cout << "pi_deleglise_rivat_64(" << x << ") = " << res;
+      check(res == 3204941750802);
+      check_chunks(chunks, threads_per_group, threads);
+    }
+
+    {
+      int64_t x = (int64_t) 1e12;
+      int64_t chunks = get_group_chunks();
+      int64_t res = pi_lmo_parallel(x, threads);
+      std::cout << "pi_lmo_parallel(" << x << ") = " << res;
+      check(res == 37607912018);
+      check_chunks(chunks, threads_per_group, threads);
+    }
+
+    {
+      int64_t x = (int64_t) 1e12;
+      int64_t chunks = get_group_chunks();
+      int64_t res = mertens(x, threads);
+      std::cout << "mertens(" << x << ") = " << res;
+      check(res == 62366);
+      check_chunks(chunks, threads_per_group, threads);
+    }
+  }
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+///
+/// @file   warm_cache.cpp
+/// @brief  Test the warm cache used in server mode (primecount
+///         --stdin). Computing a second x must reuse the PiTable,
+///         the primes and the sieve buffers of the first
+///         computation instead of allocating new ones.
+///
+/// Copyright (C) 2024 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primecount.hpp>
+#include <primecount-internal.hpp>
+#include <WarmCache.hpp>
+#include <PiTable.hpp>
+#include <Sieve.hpp>
+#include <Vector.hpp>
+#include <gourdon.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace primecount;
+
+void check(bool OK)
+{
+  std::cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    std::exit(1);
+}
+
+int main()
+{
+  int threads = 4;
+  set_warm_cache(true);
+
+  {
+    auto pi1 = get_pi_table(1000000, threads);
+    auto pi2 = get_pi_table(100000, threads);
+    std::cout << "get_pi_table(10^5) reuses PiTable(10^6)";
+    check(pi1.get() == pi2.get());
+
+    auto pi3 = get_pi_table(2000000, threads);
+    std::cout << "get_pi_table(2 * 10^6) grows PiTable";
+    check(pi3.get() != pi1.get() && pi3->size() >= 2000001);
+    std::cout << "pi(10^6) = " << (*pi3)[1000000];
+    check((*pi3)[1000000] == 78498);
+  }
+
+  {
+    auto primes1 = get_primes<uint32_t>(1000000, threads);
+    auto primes2 = get_primes<uint32_t>(1000, threads);
+    std::cout << "get_primes(10^3) reuses primes(10^6)";
+    check(primes1->data() == primes2->data());
+    std::cout << "primes[168] = " << (*primes2)[168];
+    check((*primes2)[168] == 997);
+  }
+
+  {
+    Vector<uint8_t> buffer;
+    take_sieve_buffer(buffer);
+    buffer.resize(1 << 12);
+    uint8_t* data = buffer.data();
+    put_sieve_buffer(buffer);
+
+    { Sieve sieve(0, 1 << 15, 10); }
+    take_sieve_buffer(buffer);
+    std::cout << "Sieve reuses sieve buffer";
+    check(buffer.data() == data);
+    put_sieve_buffer(buffer);
+  }
+
+  // Same code path as primecount --stdin, the second
+  // computation must not allocate a new PiTable.
+  int64_t x1 = (int64_t) 1e12;
+  int64_t x2 = (int64_t) 1e11;
+
+  int64_t res1 = pi_gourdon_64(x1, threads, false);
+  auto pi1 = get_pi_table(0, threads);
+  std::cout << "pi_gourdon_64(" << x1 << ") = " << res1;
+  check(res1 == 37607912018);
+
+  int64_t res2 = pi_gourdon_64(x2, threads, false);
+  auto pi2 = get_pi_table(0, threads);
+  std::cout << "pi_gourdon_64(" << x2 << ") = " << res2;
+  check(res2 == 4118054813);
+  std::cout << "pi_gourdon_64(" << x2 << ") reuses PiTable";
+  check(pi1.get() == pi2.get());
+
+  set_warm_cache(false);
+
+  std::cout << std::endl;
+  std::cout << "All tests passed successfully!" << std::endl;
+
+  return 0;
+}